@@ -53,11 +53,13 @@
 //
 
 #include <iostream>
+#include <memory>
 #include <string>
 
 #include "analyze.h"
 #include "assemble.h"
 #include "binfhecontext.h"
+#include "client.h"
 #include "test_adder.h"
 #include "utils.h"
 
@@ -67,13 +69,22 @@ int main(int argc, char **argv) {
   lbcrypto::BINFHE_PARAMSET set(lbcrypto::STD128_OPT);
   lbcrypto::BINFHE_METHOD method(lbcrypto::GINX);
   bool verbose(false);
+  ExecutorEnum executor(ExecutorEnum::OMP);
+  ScheduleEnum schedule(ScheduleEnum::DYNAMIC);
+  std::string key_store;                 // none unless -k is given
+  XorEnum xor_mode(XorEnum::DECOMPOSED); // for the parameter set unless -x
 
   // note parse inputs has several parameters we do not use in this simple case.
 
-  bool dummy1, dummy2, dummy3;
+  bool dummy1, dummy2, dummy3, dummy5;
   unsigned int dummy4;
   parse_inputs(argc, argv, &dummy1, &dummy2, &dummy3, &verbose, &set, &method,
-               &dummy4, &num_test_loops);
+               &dummy4, &num_test_loops, &dummy5, &executor, &schedule,
+               &key_store, &xor_mode);
+
+  // one key set is shared by every circuit of the run
+  auto keys = std::make_shared<const CircuitClient>(set, method, xor_mode,
+                                                    key_store);
 
   std::cout << "Test bench for 2bit adder" << std::endl;
 
@@ -91,7 +102,7 @@ int main(int argc, char **argv) {
   insureFileExists(outputFname);
 
   bool passed;
-  passed = test_adder(outputFname, num_test_loops, set, method);
+  passed = test_adder(outputFname, num_test_loops, keys, executor, schedule);
   all_passed = all_passed && passed;
 
   std::cout << "===========================" << std::endl;
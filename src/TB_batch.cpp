@@ -0,0 +1,113 @@
+// @file TB_batch.cpp -- Test bed for batched evaluation of one circuit
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other
+// contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+//
+
+//
+//
+// Test Bench script to load one circuit and evaluate it on every input
+// record of a file with Circuit::EvaluateBatch(), which interleaves the
+// gates of all of the evaluations in one scheduler.
+//
+// usage: TB_batch [flags] [circuit file] [record file]
+// the defaults run examples/new_bristol_ckts/arith/adder64.txt on
+// examples/new_bristol_ckts/arith/adder64_records.txt
+//
+// The -a, -z, -f, -b, -c and -n flags are ignored.
+//
+
+#include <getopt.h>
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "binfhecontext.h"
+
+#include "client.h"
+#include "test_batch.h"
+#include "utils.h"
+
+int main(int argc, char **argv) {
+  std::cout << "Test bench for batched evaluation" << std::endl;
+
+  bool analyze_flag = false;
+  bool gen_fan_flag = false;
+  bool binary_flag = false;
+  bool assemble_flag = false;
+
+  unsigned int n_cases = 1;
+  unsigned int num_test_loops = 1;
+
+  lbcrypto::BINFHE_PARAMSET set(lbcrypto::STD128_OPT);
+  lbcrypto::BINFHE_METHOD method(lbcrypto::GINX);
+  bool verbose(false);
+  ExecutorEnum executor(ExecutorEnum::OMP);
+  ScheduleEnum schedule(ScheduleEnum::DYNAMIC);
+  std::string key_store;                 // none unless -k is given
+  XorEnum xor_mode(XorEnum::DECOMPOSED); // for the parameter set unless -x
+
+  parse_inputs(argc, argv, &assemble_flag, &gen_fan_flag, &analyze_flag,
+               &verbose, &set, &method, &n_cases, &num_test_loops,
+               &binary_flag, &executor, &schedule, &key_store, &xor_mode);
+
+  // one key set is shared by every circuit of the run
+  auto keys = std::make_shared<const CircuitClient>(set, method, xor_mode,
+                                                    key_store);
+
+  // the file names follow the flags
+  std::string cktFname = "examples/new_bristol_ckts/arith/adder64.txt";
+  std::string recordFname =
+      "examples/new_bristol_ckts/arith/adder64_records.txt";
+  if (optind < argc) {
+    cktFname = argv[optind];
+  }
+  if (optind + 1 < argc) {
+    recordFname = argv[optind + 1];
+  }
+  insureFileExists(cktFname);
+  insureFileExists(recordFname);
+
+  bool passed;
+  passed = test_batch(cktFname, recordFname, keys, executor, schedule);
+
+  std::cout << "===========================" << std::endl;
+  std::cout << cktFname << " ";
+  if (passed) {
+    std::cout << "passes" << std::endl;
+  } else {
+    std::cout << "fails" << std::endl;
+  }
+  std::cout << "===========================" << std::endl;
+}
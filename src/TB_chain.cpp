@@ -0,0 +1,101 @@
+// @file TB_chain.cpp -- Test bed for chained circuits
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other
+// contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+//
+
+//
+//
+// Test Bench script to chain the new style ("Bristol Fashion") adder64,
+// mult64 and sub64 circuits into one circuit on encrypted wires, and then
+// run and test the result with an encrypted circuit evaluator.
+//
+// The circuits are not analyzed or assembled, so the -a, -z, -f, -b and
+// -c flags are ignored.
+//
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "binfhecontext.h"
+
+#include "client.h"
+#include "test_chain.h"
+#include "utils.h"
+
+int main(int argc, char **argv) {
+  std::cout << "Test bench for chained circuits" << std::endl;
+
+  bool analyze_flag = false;
+  bool gen_fan_flag = false;
+  bool binary_flag = false;
+  bool assemble_flag = false;
+
+  unsigned int n_cases = 1;
+
+  unsigned int num_test_loops = 10;
+
+  lbcrypto::BINFHE_PARAMSET set(lbcrypto::STD128_OPT);
+  lbcrypto::BINFHE_METHOD method(lbcrypto::GINX);
+  bool verbose(false);
+  ExecutorEnum executor(ExecutorEnum::OMP);
+  ScheduleEnum schedule(ScheduleEnum::DYNAMIC);
+  std::string key_store;                 // none unless -k is given
+  XorEnum xor_mode(XorEnum::DECOMPOSED); // for the parameter set unless -x
+
+  parse_inputs(argc, argv, &assemble_flag, &gen_fan_flag, &analyze_flag,
+               &verbose, &set, &method, &n_cases, &num_test_loops,
+               &binary_flag, &executor, &schedule, &key_store, &xor_mode);
+
+  // one key set is shared by every circuit of the run
+  auto keys = std::make_shared<const CircuitClient>(set, method, xor_mode,
+                                                    key_store);
+
+  std::string dirPath = "examples/new_bristol_ckts/arith";
+  insureFileExists(dirPath + "/adder64.txt");
+  insureFileExists(dirPath + "/mult64.txt");
+  insureFileExists(dirPath + "/sub64.txt");
+
+  bool passed;
+  passed = test_chain(dirPath, num_test_loops, keys, executor, schedule);
+
+  std::cout << "===========================" << std::endl;
+  std::cout << "adder64 -> mult64 -> sub64 chain ";
+  if (passed) {
+    std::cout << "passes" << std::endl;
+  } else {
+    std::cout << "fails" << std::endl;
+  }
+  std::cout << "===========================" << std::endl;
+}
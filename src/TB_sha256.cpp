@@ -61,12 +61,14 @@
 //
 
 #include <iostream>
+#include <memory>
 #include <string>
 
 #include "binfhecontext.h"
 
 #include "analyze.h"
 #include "assemble.h"
+#include "client.h"
 #include "test_sha256.h"
 #include "utils.h"
 
@@ -75,6 +77,7 @@ int main(int argc, char **argv) {
 
   bool analyze_flag = false;
   bool gen_fan_flag = false;
+  bool binary_flag = false; // also write compiled circuit when assembling
   bool assemble_flag = true && analyze_flag; // cant assemble without analysis
 
   unsigned int n_cases = 1;
@@ -83,9 +86,18 @@ int main(int argc, char **argv) {
   lbcrypto::BINFHE_PARAMSET set(lbcrypto::STD128_OPT);
   lbcrypto::BINFHE_METHOD method(lbcrypto::GINX);
   bool verbose(false);
+  ExecutorEnum executor(ExecutorEnum::OMP);
+  ScheduleEnum schedule(ScheduleEnum::DYNAMIC);
+  std::string key_store;                 // none unless -k is given
+  XorEnum xor_mode(XorEnum::DECOMPOSED); // for the parameter set unless -x
 
   parse_inputs(argc, argv, &assemble_flag, &gen_fan_flag, &analyze_flag,
-               &verbose, &set, &method, &n_cases, &num_test_loops);
+               &verbose, &set, &method, &n_cases, &num_test_loops,
+               &binary_flag, &executor, &schedule, &key_store, &xor_mode);
+
+  // one key set is shared by every circuit of the run
+  auto keys = std::make_shared<const CircuitClient>(set, method, xor_mode,
+                                                    key_store);
 
   // note n_cases is ignored
   if (n_cases != 1) {
@@ -125,13 +137,13 @@ int main(int argc, char **argv) {
     //  now assemble note this writes out a new version of .out
 
     std::cout << "assembling " << inputFname << std::endl;
-    assemble_bristol(analysis_result, max_depth, debug_flag);
+    assemble_bristol(analysis_result, max_depth, debug_flag, binary_flag);
   }
 
   insureFileExists(outputFname);
 
   bool passed;
-  passed = test_sha256(outputFname, num_test_loops, set, method);
+  passed = test_sha256(outputFname, num_test_loops, keys, executor, schedule);
 
   std::cout << "===========================" << std::endl;
   std::cout << outputFname << " ";
@@ -0,0 +1,167 @@
+// @file TB_techmap.cpp -- Test bed for the technology mapping passes
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other
+// contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+//
+//
+// Test Bench script to rewrite Bristol circuits with the technology mapping
+// passes of techmap.h (LUT mapping, gate fusing and pattern matching), and
+// then run and test the rewritten circuits with an encrypted circuit
+// evaluator. The new style ("Bristol Fashion") arithmetic circuits and the
+// old style comparators are loaded directly.
+//
+// The circuits are not analyzed or assembled, so the -a, -z, -f and -b
+// flags are ignored.
+//
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "binfhecontext.h"
+
+#include "client.h"
+#include "test_techmap.h"
+#include "utils.h"
+
+int main(int argc, char **argv) {
+  std::cout << "Test bench for technology mapping" << std::endl;
+
+  bool analyze_flag = false;
+  bool gen_fan_flag = false;
+  bool binary_flag = false;
+  bool assemble_flag = false;
+
+  unsigned int n_cases = 12;
+
+  unsigned int num_test_loops = 10;
+
+  lbcrypto::BINFHE_PARAMSET set(lbcrypto::STD128_OPT);
+  lbcrypto::BINFHE_METHOD method(lbcrypto::GINX);
+  bool verbose(false);
+  ExecutorEnum executor(ExecutorEnum::OMP);
+  ScheduleEnum schedule(ScheduleEnum::DYNAMIC);
+  std::string key_store;                 // none unless -k is given
+  XorEnum xor_mode(XorEnum::DECOMPOSED); // for the parameter set unless -x
+
+  parse_inputs(argc, argv, &assemble_flag, &gen_fan_flag, &analyze_flag,
+               &verbose, &set, &method, &n_cases, &num_test_loops,
+               &binary_flag, &executor, &schedule, &key_store, &xor_mode);
+
+  // one key set is shared by every circuit of the run, the rewritten
+  // circuits that need another encoding get their own
+  auto keys = std::make_shared<const CircuitClient>(set, method, xor_mode,
+                                                    key_store);
+
+  std::string inputFname;
+  std::string dirPath;
+  bool new_flag;
+
+  bool all_passed = true;
+  for (unsigned int i = 0; i < n_cases; i++) {
+    dirPath = "examples/new_bristol_ckts/arith";
+    new_flag = true;
+    switch (i) {
+    case 0:
+      inputFname = "adder64.txt";
+      break;
+    case 1:
+      inputFname = "sub64.txt";
+      break;
+    case 2:
+      inputFname = "neg64.txt";
+      break;
+    case 3:
+      inputFname = "zero_equal.txt";
+      break;
+    case 4:
+      inputFname = "mult64.txt";
+      break;
+    case 5:
+      inputFname = "mult2_64.txt";
+      break;
+    case 6:
+      inputFname = "udivide64.txt";
+      break;
+    case 7:
+      inputFname = "divide64.txt";
+      break;
+    case 8:
+      dirPath = "examples/old_bristol_ckts/arith";
+      new_flag = false;
+      inputFname = "comparator_32bit_signed_lteq.txt";
+      break;
+    case 9:
+      dirPath = "examples/old_bristol_ckts/arith";
+      new_flag = false;
+      inputFname = "comparator_32bit_unsigned_lteq.txt";
+      break;
+    case 10:
+      dirPath = "examples/old_bristol_ckts/arith";
+      new_flag = false;
+      inputFname = "comparator_32bit_signed_lt.txt";
+      break;
+    case 11:
+      dirPath = "examples/old_bristol_ckts/arith";
+      new_flag = false;
+      inputFname = "comparator_32bit_unsigned_lt.txt";
+      break;
+    default:
+      std::cout << "bad case number:" << i << std::endl;
+      exit(-1);
+    }
+    inputFname = dirPath + "/" + inputFname;
+
+    insureFileExists(inputFname);
+
+    bool passed;
+    passed = test_techmap(inputFname, new_flag, num_test_loops, keys,
+                          executor, schedule);
+    all_passed = all_passed && passed;
+
+    std::cout << "===========================" << std::endl;
+    std::cout << inputFname << " ";
+    if (passed) {
+      std::cout << "passes" << std::endl;
+    } else {
+      std::cout << "fails" << std::endl;
+    }
+  } // loop over case i
+  std::cout << "===========================" << std::endl;
+  if (all_passed) {
+    std::cout << "All technology mapping cases passed" << std::endl;
+  } else {
+    std::cout << "Some technology mapping cases failed" << std::endl;
+  }
+  std::cout << "===========================" << std::endl;
+}
@@ -35,9 +35,11 @@
 #include "analyze.h"
 
 #include <algorithm>
-#include <cstring>
 #include <functional>
 #include <iostream>
+#include <utility>
+
+#include "cktfile.h"
 
 Variable::Variable(void){
 
@@ -90,15 +92,16 @@ Analysis analyze_bristol(std::string in_fname, bool gen_fan_flag,
   //  Known Issues:
   //    None.
   //
-  //
-  // note this file was translated from matlab which uses C file IO
-
-  // //  open the file name
-  FILE *fid = fopen(in_fname.c_str(), "r");
+  //  The file is memory mapped and walked once. Gate counts, high and low
+  //  water, life, fan in and fan out are all accumulated as each gate is
+  //  parsed, so analysis is linear in the size of the file.
 
   std::cout << "analyzing file " << in_fname << std::endl;
-  if (fid == NULL) {
+  TIC(auto t_analyze);
+  TextFileMap in;
+  if (!in.Open(in_fname)) {
     std::cout << "error opening file.. exiting!" << std::endl;
+    exit(-1);
   }
 
   //  parse the header of the file.
@@ -106,77 +109,41 @@ Analysis analyze_bristol(std::string in_fname, bool gen_fan_flag,
   //  the first line for two variables
   std::cout << "Analysis Report for input file " << in_fname << std::endl;
   std::cout << "Parsing circuit i/o" << std::endl;
-  char *remain;
-  char *token;
-  int buffsize = 256;
-  char buff[buffsize];
-
-  remain = fgets(buff, sizeof buff, fid);
-  token = std::strtok(remain, " ");
-  unsigned int n_tot_func;
-  sscanf(token, "%ul", &n_tot_func);
-  token = std::strtok(NULL, " ");
-  unsigned int n_tot_var;
-  sscanf(token, "%d", &n_tot_var);
+  uint32_t n_tot_func(0);
+  uint32_t n_tot_var(0);
+  bool ok = in.NextUint(&n_tot_func) && in.NextUint(&n_tot_var);
   std::cout << "Total number of nodes: " << n_tot_var << std::endl;
 
-  unsigned int n_inputs;
-  unsigned int n_in1_var(0);
-  unsigned int n_in2_var(0);
-  unsigned int n_outputs;
-  unsigned int n_out1_var(0);
+  uint32_t n_inputs(2);
+  uint32_t n_in1_var(0);
+  uint32_t n_in2_var(0);
+  uint32_t n_outputs(1);
+  uint32_t n_out1_var(0);
 
   if (new_flag) {
     std::cout << "new" << std::endl;
-    n_inputs = 2;
-    n_outputs = 1;
     // new "bristol fashion" files have slightly different header
-
-    // parse the second line for three variables
-    remain = fgets(buff, sizeof buff, fid);
-    token = std::strtok(remain, " ");
-    sscanf(token, "%ul", &n_inputs);
-
-    token = std::strtok(NULL, " ");
-    sscanf(token, "%ul", &n_in1_var);
-
-    token = std::strtok(NULL, " ");
-    sscanf(token, "%d", &n_in2_var);
-
-    remain = fgets(buff, sizeof buff, fid);
-    token = std::strtok(remain, " ");
-
-    sscanf(token, "%d", &n_outputs); // always 1
-
-    token = std::strtok(NULL, " ");
-    sscanf(token, "%d", &n_out1_var);
-
-    // parse the fourth line for a blank
-    char *blank;
-    blank = fgets(buff, sizeof buff, fid);
-    (void)blank;
-
+    // n_inputs n_in1 n_in2 on the second line, n_outputs n_out1 on the third
+    ok = ok && in.NextUint(&n_inputs) && in.NextUint(&n_in1_var);
+    if (ok && (n_inputs == 2)) {
+      ok = in.NextUint(&n_in2_var);
+    }
+    ok = ok && in.NextUint(&n_outputs) && in.NextUint(&n_out1_var);
+    if (ok && ((n_inputs < 1) || (n_inputs > 2) || (n_outputs != 1))) {
+      std::cout << "analyzer only supports one or two inputs and one output"
+                << std::endl;
+      exit(-1);
+    }
   } else {
     std::cout << "old" << std::endl;
-    n_inputs = 2;
-    n_outputs = 1;
     // use the old format
     // parse the second line for three variables
-    remain = fgets(buff, sizeof buff, fid);
-    token = std::strtok(remain, " ");
-
-    sscanf(token, "%ul", &n_in1_var);
-    token = std::strtok(NULL, " ");
-
-    sscanf(token, "%d", &n_in2_var);
-    token = std::strtok(NULL, " ");
-    ;
-
-    sscanf(token, "%d", &n_out1_var);
-    // parse the third line for a blank
-    char *blank;
-    blank = fgets(buff, sizeof buff, fid);
-    (void)blank;
+    ok = ok && in.NextUint(&n_in1_var) && in.NextUint(&n_in2_var) &&
+         in.NextUint(&n_out1_var);
+  }
+  if (!ok) {
+    std::cout << "bad parse of file header" << std::endl;
+    exit(-1);
   }
   std::cout << "number bits input 1 = " << n_in1_var << std::endl;
   if (n_inputs == 2) {
@@ -196,9 +163,16 @@ Analysis analyze_bristol(std::string in_fname, bool gen_fan_flag,
   // variable counters
   std::vector<unsigned int> var_high_water(n_tot_var, 0);
   std::vector<unsigned int> var_low_water(n_tot_var, 0);
-  std::vector<unsigned int> var_life(n_tot_var, 0);
-  std::vector<unsigned int> var_fan_in(n_tot_var, 0);
-  std::vector<unsigned int> var_fan_out(n_tot_var, 0);
+  std::vector<bool> var_seen(n_tot_var, false);
+  std::vector<unsigned int> var_fan_in;
+  std::vector<unsigned int> var_fan_out;
+  if (gen_fan_flag) {
+    std::cout << "parsing fan in, fan out" << std::endl;
+    var_fan_in.assign(n_tot_var, 0);
+    var_fan_out.assign(n_tot_var, 0);
+  } else {
+    std::cout << "not parsing fan in, fan out" << std::endl;
+  }
 
   // resulting function call list.
   std::vector<std::string> func_call_list(n_tot_func);
@@ -220,85 +194,79 @@ Analysis analyze_bristol(std::string in_fname, bool gen_fan_flag,
   std::vector<std::vector<unsigned int>> func_in_list(n_tot_func);
   std::vector<std::vector<unsigned int>> func_out_list(n_tot_func);
 
-  for (uint ix = 0; ix < n_tot_func; ix++) {
-    std::vector<unsigned int> inlist;  // list of input nodes
-    std::vector<unsigned int> outlist; // list of output nodes
+  // low water is first gate that uses the node, high water is last gate
+  auto touch = [&](uint32_t node, unsigned int ix) {
+    if (!var_seen[node]) {
+      var_seen[node] = true;
+      var_low_water[node] = ix;
+    }
+    var_high_water[node] = ix;
+  };
 
+  for (uint ix = 0; ix < n_tot_func; ix++) {
     //  get # in and out nodes
-    remain = fgets(buff, sizeof buff, fid);
-
-    token = std::strtok(remain, " ");
-    ;
-
-    unsigned int nin;
-    sscanf(token, "%d", &nin);
-    token = std::strtok(NULL, " ");
-    unsigned int nout;
-    sscanf(token, "%d", &nout);
-
-    unsigned int tmp;
-    for (uint jj = 0; jj < nin; jj++) { // read list of input nodes
-      token = std::strtok(NULL, " ");
-      sscanf(token, "%d", &tmp);
-      inlist.push_back(tmp);
+    uint32_t nin(0);
+    uint32_t nout(0);
+    ok = in.NextUint(&nin) && in.NextUint(&nout);
+
+    std::vector<unsigned int> &inlist = func_in_list[ix]; // input nodes
+    std::vector<unsigned int> &outlist = func_out_list[ix]; // output nodes
+    inlist.resize(nin);
+    outlist.resize(nout);
+    uint32_t node;
+    for (uint jj = 0; ok && (jj < nin); jj++) { // read list of input nodes
+      ok = in.NextUint(&node) && (node < n_tot_var);
+      inlist[jj] = node;
     }
-    for (uint jj = 0; jj < nout; jj++) { // read list of output nodes
-      token = std::strtok(NULL, " ");
-      sscanf(token, "%d", &tmp);
-      outlist.push_back(tmp);
+    for (uint jj = 0; ok && (jj < nout); jj++) { // read list of output nodes
+      ok = in.NextUint(&node) && (node < n_tot_var);
+      outlist[jj] = node;
+    }
+    const char *tok;
+    size_t len;
+    ok = ok && in.NextToken(&tok, &len);
+    if (!ok) {
+      std::cout << "bad parse of function on line " << ix << std::endl;
+      exit(-1);
     }
 
-    token = std::strtok(NULL, " ");
-    ;
-    // inlist = inlist+1; // indicies are starting at 1, node names at 0
-    // outlist = outlist+1; // indicies are starting at 1, node names at 0
-    func_in_list[ix] = inlist;
-    func_out_list[ix] = outlist;
-
-    *std::remove(token, token + strlen(token), '\n') =
-        '\0'; // removes _all_ new lines.
-    std::string str = std::string(token);
-    for (auto &c : str)
-      c = toupper(c); // convert to uppercase
-    // token =  toupper(token); // parse function call
-    if (str == "XOR") {
+    if (tokenIs(tok, len, "XOR")) {
       n_xor = n_xor + 1;
-      func_call_list[ix] = "XOR"; // function token for xor
-    } else if (str == "AND") {
+      func_call_list[ix] = func_names[xor_ix]; // function token for xor
+    } else if (tokenIs(tok, len, "AND")) {
       n_and = n_and + 1;
-      func_call_list[ix] = "AND"; // function token for xor
-    } else if (str == "INV") {
+      func_call_list[ix] = func_names[and_ix]; // function token for and
+    } else if (tokenIs(tok, len, "INV")) {
       n_not = n_not + 1;
-      func_call_list[ix] = "NOT"; // function token for inv
-    } else if (str == "EQ") {
+      func_call_list[ix] = func_names[not_ix]; // function token for inv
+    } else if (tokenIs(tok, len, "EQ")) {
       n_eq = n_eq + 1;
-      func_call_list[ix] = " EQ"; // function token for inv
+      func_call_list[ix] = func_names[eq_ix]; // function token for eq
       std::cout << "Cannot parse EQ!! yet failing" << std::endl;
       exit(-1);
-    } else if (str == "EQW") {
+    } else if (tokenIs(tok, len, "EQW")) {
       n_eqw = n_eqw + 1;
-      func_call_list[ix] = "EQW"; // function token for inv
+      func_call_list[ix] = func_names[eqw_ix]; // function token for eqw
     } else {
       std::cout << "bad parse of function on line " << ix << std::endl;
     }
 
-    // generate high and low water marks for each node
-    // low water is first gate that uses the node, high water is last gate
+    // generate high and low water marks, fan in and fan out for each node
     for (const auto &jj : inlist) { // (note node name start at 0
-      if (var_low_water[jj] == 0) {
-        var_low_water[jj] = ix;
+      touch(jj, ix);
+      if (gen_fan_flag) {
+        var_fan_out[jj]++;
       }
-      var_high_water[jj] = ix;
     }
     for (const auto &jj : outlist) {
-      if (var_low_water[jj] == 0) {
-        var_low_water[jj] = ix;
+      touch(jj, ix);
+      if (gen_fan_flag) {
+        var_fan_in[jj]++; // should always be max 1
       }
-      var_high_water[jj] = ix;
     }
   } // for ix
 
-  fclose(fid);
+  in.Close();
 
   std::cout << " number of and " << n_and << std::endl;
   std::cout << " number of xor " << n_xor << std::endl;
@@ -306,49 +274,6 @@ Analysis analyze_bristol(std::string in_fname, bool gen_fan_flag,
   std::cout << " number of eq " << n_eq << std::endl;
   std::cout << " number of weqw " << n_eqw << std::endl;
 
-#if 1
-  //  generate fan in and fan out lists
-  if (gen_fan_flag) {
-    std::cout << "parsing fan in, fan out" << std::endl;
-
-    for (uint ix = 0; ix < n_tot_var; ix++) {
-      if (ix % 100 == 0) {
-        std::cout << "\r parsing node " << ix << std::flush;
-      }
-      for (uint jx = 0; jx < n_tot_func; jx++) {
-        auto templist = func_in_list[jx];
-
-        if (1) { // c way
-          for (uint kx = 0; kx < templist.size(); kx++) {
-            if (ix == templist[kx]) {
-              var_fan_out[ix] = var_fan_out[ix] + 1;
-            }
-          }
-        } else { // matlab way
-          // kx = find(templist==ix);
-          // var_fan_out[ix] = var_fan_out[ix] + length(kx);
-        }
-
-        templist = func_out_list[jx];
-        if (1) {
-          for (uint kx = 0; kx < templist.size(); kx++) {
-            if (ix == templist[kx]) {
-              var_fan_in[ix] = var_fan_in[ix] + 1; // should always be max 1
-            }
-          }
-        } else {
-          // kx = find(templist==ix);
-          // var_fan_in[ix] = var_fan_in[ix] + length(kx);
-        }
-      }
-    }
-
-  } else {
-    std::cout << "not parsing fan in, fan out" << std::endl;
-    var_fan_in.clear();
-    var_fan_out.clear();
-  }
-#endif
   Analysis retVal;
 
   retVal.variables.in_fname = in_fname;
@@ -358,37 +283,44 @@ Analysis analyze_bristol(std::string in_fname, bool gen_fan_flag,
   retVal.variables.n_in1_bits = n_in1_var;
   retVal.variables.n_in2_bits = n_in2_var;
   retVal.variables.n_out1_bits = n_out1_var;
-  retVal.variables.high_water = var_high_water;
-  retVal.variables.low_water = var_low_water;
 
   // var_life = var_high_water-var_low_water;
+  std::vector<unsigned int> var_life(n_tot_var, 0);
   std::transform(var_high_water.begin(), var_high_water.end(),
                  var_low_water.begin(), var_life.begin(), std::minus<int>());
-  retVal.variables.life = var_life;
-
-  retVal.variables.fan_in = var_fan_in;
-  retVal.variables.fan_out = var_fan_out;
 
-  unsigned int max_fan_in = *max_element(var_fan_in.begin(), var_fan_in.end());
-  unsigned int max_fan_out =
-      *max_element(var_fan_out.begin(), var_fan_out.end());
-  unsigned int max_life = *max_element(var_life.begin(), var_life.end());
+  if (gen_fan_flag && (n_tot_var > 0)) {
+    unsigned int max_fan_in =
+        *max_element(var_fan_in.begin(), var_fan_in.end());
+    unsigned int max_fan_out =
+        *max_element(var_fan_out.begin(), var_fan_out.end());
+    std::cout << "max fan in (should be 1) = " << max_fan_in << std::endl;
+    std::cout << "max fan out = " << max_fan_out << std::endl;
+  }
+  if (n_tot_var > 0) {
+    unsigned int max_life = *max_element(var_life.begin(), var_life.end());
+    std::cout << "max variable life = " << max_life << std::endl;
+  }
 
-  std::cout << "max fan in (should be 1) = " << max_fan_in << std::endl;
-  std::cout << "max fan out = " << max_fan_out << std::endl;
-  std::cout << "max variable life = " << max_life << std::endl;
+  retVal.variables.high_water = std::move(var_high_water);
+  retVal.variables.low_water = std::move(var_low_water);
+  retVal.variables.life = std::move(var_life);
+  retVal.variables.fan_in = std::move(var_fan_in);
+  retVal.variables.fan_out = std::move(var_fan_out);
 
   retVal.functions.in_fname = in_fname;
   retVal.functions.n_tot = n_tot_func;
-  retVal.functions.call_list = func_call_list;
-  retVal.functions.in_list = func_in_list;
-  retVal.functions.out_list = func_out_list;
+  retVal.functions.call_list = std::move(func_call_list);
+  retVal.functions.in_list = std::move(func_in_list);
+  retVal.functions.out_list = std::move(func_out_list);
   retVal.functions.n_and = n_and;
   retVal.functions.n_xor = n_xor;
   retVal.functions.n_not = n_not;
   retVal.functions.n_eq = n_eq;
-  retVal.functions.n_eqw = n_eq;
+  retVal.functions.n_eqw = n_eqw;
   retVal.functions.names = func_names;
 
+  std::cout << "### Analysis time " << TOC_MS(t_analyze) << " msec"
+            << std::endl;
   return retVal;
 }
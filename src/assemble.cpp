@@ -34,6 +34,7 @@
 //==================================================================================
 #include "assemble.h"
 #include "analyze.h"
+#include "cktfile.h"
 #include <algorithm>
 #include <cstring>
 #include <functional>
@@ -44,7 +45,7 @@
 // currently works but does not compute depth.
 
 void assemble_bristol(Analysis &analysis, unsigned int max_depth,
-                      bool debug_flag) {
+                      bool debug_flag, bool binary_flag) {
   //
   // Code to generate an assembler listing from a variable and function list
   // that has been generated by processing an circuit description file with
@@ -59,10 +60,16 @@ void assemble_bristol(Analysis &analysis, unsigned int max_depth,
   // gates/functions by the analyze() function. for every line operation in the
   // orginal input file the code maps circuit nodes (listed in var) to a list of
   // registers, the system also generates an assembly listing for that function,
-  // with the appropriate input and output "gates" addeda Additionally, the code
-  // keeps track of each AND, and updates a count of the depth of each variable.
-  // If the count equals the max_depth, then a recrypt BOOT command is given,
-  // and the depth reset.
+  // with the appropriate input and output "gates" addeda. No BOOT commands
+  // are generated, the evaluator bootstraps every gate, so AND and XOR are
+  // listed at depth 1 and NOT at depth 0.
+  //
+  // Registers are allocated with a linear scan. A node is given a free
+  // register when it is written, and the register is freed after the last
+  // gate that reads the node (its high_water from analyze()). Circuit
+  // outputs stay live until they are stored at the end. Since registers are
+  // reused, each write of register r is numbered and named R<r>.<version>,
+  // so every name in the listing is still assigned exactly once.
   //
   // Input
   //   Analysis.v = variable structure from analyze()
@@ -70,9 +77,12 @@ void assemble_bristol(Analysis &analysis, unsigned int max_depth,
   //   max_depth = maximum depth the SHE scheme will support, set to zero
   //               to avoid bootstrapping.
   //   debug_flag = adds debug comments to code.
+  //   binary_flag = also write a compiled circuit (.ckt) file.
   // Output
   //   A file (currently the input file with _max_depth.txt or _fhe.txt
   //   concatenated) with the listing
+  //   If binary_flag is set, the same circuit in compiled form with
+  //   the .out replaced by .ckt, see cktfile.h
   //
   // Version History:
   //   original matlab started 12/06/2012 by D. Cousins
@@ -85,9 +95,6 @@ void assemble_bristol(Analysis &analysis, unsigned int max_depth,
   Variable v = analysis.variables;
   Function f = analysis.functions;
 
-  if (v.new_flag) {
-    std::cout << "Have not updated assembler for new format" << std::endl;
-  }
   // get the filename used, and remove any extension
   std::string fname;
   fname = std::string(v.in_fname);
@@ -115,90 +122,110 @@ void assemble_bristol(Analysis &analysis, unsigned int max_depth,
 
   bool delayed_get_flag = true; // if true, delay get of all registers till end
                                 // otherwise get output right after operation
-                                // map of registers
-  std::vector<bool> reg_active_map(v.n_tot,
-                                   false); // if true then register (i) is
-                                           // currently being used value false
-                                           // = unused value true = used
 
-  std::vector<int> reg_node_map(
-      v.n_tot, -1); // current circuit node number stored in register (i)
-                    // value == node number, -1 == no node.
+  // map of registers
+  std::vector<int> node_reg_map(
+      v.n_tot, -1); // register currently holding circuit node (i)
+                    // value == register number, -1 == not in a register.
+
+  std::vector<unsigned int> node_ver_map(
+      v.n_tot, 0); // version of the register write that holds node (i)
+
+  std::vector<unsigned int> reg_ver_count; // number of writes to register (i)
+                                           // size is the # registers used
 
-  std::vector<int> out_map(v.n_out1_bits, -1); // map of the output registers.
+  std::vector<unsigned int> free_regs; // stack of registers not in use
 
-  // (i) contains the node number of the ith output;
-  std::vector<int> out_reg_map(v.n_out1_bits,
-                               -1); // the ith entry contains the register
-                                    // number of the ith output node
+  // nodes at or above this are the circuit outputs, which are assumed to be
+  // the last nodes numbered.
+  unsigned int first_out_node = v.n_tot - v.n_out1_bits;
 
+  // depth is kept per node, since registers are reused
   std::vector<unsigned int> depth_counter(
-      v.n_tot, 0); // keeps track of depth at each register
+      v.n_tot, 0); // keeps track of depth at each node
 
-  std::vector<unsigned int> tower_counter(
-      v.n_tot, 0); // keeps track of tower size at each register
-  unsigned int max_tower_jump = 0;
+  CktFile ckt; // compiled form of the listing, wire ids are the node numbers
 
-  unsigned int max_depth_required = 0;
+  // assign the next free register to a node, allocating a new one if none
+  // are free, and return it
+  auto alloc_reg = [&](unsigned int node) -> unsigned int {
+    unsigned int reg;
+    if (free_regs.empty()) {
+      reg = reg_ver_count.size();
+      reg_ver_count.push_back(0);
+    } else {
+      reg = free_regs.back();
+      free_regs.pop_back();
+    }
+    node_reg_map[node] = reg;
+    node_ver_map[node] = reg_ver_count[reg]++;
+    if (debug_flag) {
+      fprintf(fid, "# Assigned node %d to R%d\n", node + ADD_IT, reg + ADD_IT);
+    }
+    return reg;
+  };
+
+  // return the register of a node to the free list after its last use
+  auto free_reg = [&](unsigned int node, unsigned int line_ix) {
+    if ((node >= first_out_node) || (node_reg_map[node] < 0) ||
+        (v.high_water[node] != line_ix)) {
+      return;
+    }
+    free_regs.push_back(node_reg_map[node]);
+    node_reg_map[node] = -1;
+  };
+
+  // inputs that no gate reads are never freed by free_reg, their
+  // registers are handed back as soon as they are loaded
+  std::vector<bool> node_read(v.n_tot, false);
+  for (auto const &inlist : f.in_list) {
+    for (auto node : inlist) {
+      node_read[node] = true;
+    }
+  }
+  auto free_unread = [&](unsigned int node) {
+    if ((node < first_out_node) && !node_read[node]) {
+      free_regs.push_back(node_reg_map[node]);
+      node_reg_map[node] = -1;
+    }
+  };
+
+  // SSA name of the register write holding a node
+  auto reg_name = [&](unsigned int node) -> std::string {
+    return "R" + std::to_string(node_reg_map[node] + ADD_IT) + "." +
+           std::to_string(node_ver_map[node]);
+  };
 
   std::cout << "Mapping input registers" << std::endl;
   ///////////////////////////////////////////////////////////////////////////
   //  map all circuit input registers
   // execute initial LOAD commands.
 
-  unsigned int reg_counter = 0; // start count from 0
-
   // load all of first input's registers;
   // note this assumes the input registers are the first nodes assigned, first
   // reg 1 then reg 2.
 
   for (uint ix = 0; ix < v.n_in1_bits; ix++) {
     // load bit ix of register in 1.
-    fprintf(fid, "R%d = LOAD(In%d,%d)\n", reg_counter + ADD_IT, 1, ix + ADD_IT);
-
-    reg_active_map[reg_counter] = true;
-    reg_node_map[reg_counter] = ix;
-    tower_counter[reg_counter] = max_depth;
-    if (debug_flag) {
-      fprintf(fid, "# Assigned node %d to R%d\n",
-              reg_node_map[reg_counter] + ADD_IT, reg_counter + ADD_IT);
-    }
-
-    reg_counter++;
+    unsigned int node = ix;
+    alloc_reg(node);
+    fprintf(fid, "%s = LOAD(In%d,%d)\n", reg_name(node).c_str(), 1,
+            ix + ADD_IT);
+    ckt.AddInput(0, ix, node);
+    free_unread(node);
   }
 
   // load all of second input's registers;
   for (uint ix = 0; ix < v.n_in2_bits; ix++) {
     // load bit ix of register in 2.
-    fprintf(fid, "R%d = LOAD(In%d,%d)\n", reg_counter + ADD_IT, 2, ix + ADD_IT);
-
-    reg_active_map[reg_counter] = true;
-    reg_node_map[reg_counter] =
-        ix + v.n_in1_bits; // see assumption of register numbering
-    tower_counter[reg_counter] = max_depth;
-    if (debug_flag) {
-      fprintf(fid, "# Assigned node %d to R%d\n",
-              reg_node_map[reg_counter] + ADD_IT, reg_counter + ADD_IT);
-    }
-    reg_counter++;
-  }
-
-  //  mark all output registers so we can keep track of them
-  // also assumes that he output registers are the last mapped.
-  size_t ii = 0;
-  for (uint ix = (v.n_tot - v.n_out1_bits); ix < v.n_tot; ix++) {
-    out_map[ii] =
-        ix; // save node mapping for iith output nodes renumbered to start at 1
-    ii++;
+    unsigned int node = ix + v.n_in1_bits; // see assumption of node numbering
+    alloc_reg(node);
+    fprintf(fid, "%s = LOAD(In%d,%d)\n", reg_name(node).c_str(), 2,
+            ix + ADD_IT);
+    ckt.AddInput(1, ix, node);
+    free_unread(node);
   }
 
-  // keep track of max number of registers in use at each line of the program
-
-  std::vector<unsigned int> active_reg_count(f.n_tot, 0);
-
-  // keep track of how many bootstrap operations get called.
-  unsigned int boot_counter = 0;
-
   //  loop over every line in the f.call_list (i.e. each boolean operation in
   // the circuit
   std::cout << "parsing functions" << std::endl;
@@ -206,65 +233,33 @@ void assemble_bristol(Analysis &analysis, unsigned int max_depth,
     if (line_ix % 100 == 0) {
       std::cout << "\r parsed line " << line_ix << std::flush;
     }
-    // for each function
-    //  find next free register for storing the output and assign the output
-    // node to it
-    unsigned int jx = 0;
-    while (reg_active_map[jx] != false) {
-      jx++;
-      if (jx == v.n_tot) {
-        std::cout << "ran out of register storage, fatal error! exiting."
+    /////////////////////////////////////////////////////////////////////////
+    // get the registers of the inputs, freeing any that are at their last
+    // use, so that the output can reuse them
+
+    auto invarlist = f.in_list[line_ix]; // get input node list
+    std::vector<std::string> invarnamelist(invarlist.size());
+
+    for (uint jx = 0; jx < invarlist.size(); jx++) {
+      if (node_reg_map[invarlist[jx]] < 0) {
+        std::cout << "input node " << invarlist[jx]
+                  << " is not in a register! fatal error, exiting!"
                   << std::endl;
         exit(-1);
       }
+      invarnamelist[jx] = reg_name(invarlist[jx]);
+    }
+    for (auto node : invarlist) {
+      free_reg(node, line_ix);
     }
-
-    // check for low water mark goes here to make sure we did not break
-    // anything
-
-    reg_active_map[jx] = true; // mark register as used
 
     /////////////////////////////////////////////////////////////////////////
-    // get the node number of the output
+    // get the node number of the output and assign it a register
     unsigned int current_out_node =
         f.out_list[line_ix][0]; // list is always 1 long
 
-    // and save it
-    reg_node_map[jx] = current_out_node;
-    unsigned int current_out_reg =
-        jx; // keep track of the current output register #
-
-    if (debug_flag) {
-      fprintf(fid, "# Assigned node %d to R%d\n", reg_node_map[jx] + ADD_IT,
-              jx + ADD_IT);
-    }
-
-    /////////////////////////////////////////////////////////////////////////
-    // get the node numbers of the inputs
-
-    auto invarlist = f.in_list[line_ix]; // get input node list
-    std::vector<unsigned int> invarnamelist(invarlist.size());
-
-    for (uint jx = 0; jx < invarlist.size(); jx++) {
-      // for each input in the list, find the register_node it is mapped to
-
-      // invarnamelist should be renamed to invar_reg_node_map_index or
-      // something
-      auto it =
-          std::find(reg_node_map.begin(), reg_node_map.end(), invarlist[jx]);
-
-      if (it != reg_node_map.end()) {
-        // std::cout << "Element " << invarlist[jx] <<" found at position : " ;
-        // std::cout << std::distance(reg_node_map.begin(), it) << " (counting
-        // from zero) \n" ;
-        invarnamelist[jx] = std::distance(reg_node_map.begin(), it);
-      } else {
-        std::cout
-            << "input register not found in reg_node_map! fatal error, exiting!"
-            << std::endl;
-        exit(-1);
-      }
-    }
+    alloc_reg(current_out_node);
+    std::string current_out_name = reg_name(current_out_node);
 
     /////////////////////////////////////////////////////////////////////////
     //  generate the line of assembly output
@@ -274,132 +269,51 @@ void assemble_bristol(Analysis &analysis, unsigned int max_depth,
     // different operators have different handlers
     // dispatch to the correct one
     if (name == "XOR") {
-#if COMPUTE_DEPTH
-      // output depth  = max (input depths)
-      depth1 = depth_counter[invarnamelist[0]];
-      depth2 = depth_counter[invarnamelist[1]];
-      input_depth = std::max(depth1, depth2);
-      output_depth = input_depth;
-      depth_counter[current_out_reg] = output_depth;
-
-      // adjust tower sizes if necessary
-      // we know that if two different depths are used we need to
-      // reduce the larger to the smaller before we can operate.
-      // issues: how is this done. do we need new registers, and if so
-      // then should we optimizez the use of these registers, or just
-      // and free them for this reduction operation, placing the result
-      // back in the same register.
-      // for now we will just report that we need a reduction.
-      if (depth1 > depth2)
-        delta_depth = depth1 - depth2;
-      //                 fprintf(fid,"R%d = MREDUCE(R%d,%d)  !depth = %d\n",...
-      //                 current_out_reg, name, invarnamelist(1),
-      //                 invarnamelist(2), output_depth);
-      fprintf(fid, "reduction of %d needed on first register\n", delta_depth);
-      if (delta_depth > max_tower)
-        jump max_tower_jump = delta_depth;
-      end elseif(depth2 > depth1) delta_depth = depth2 - depth1;
-      fprintf(fid, "reduction of %d needed on second register\n", delta_depth);
-      if (delta_depth > max_tower)
-        _ jump max_tower_jump = delta_depth;
-      end end
-#else
       output_depth = 1;
-#endif
-          // generate listing
-          fprintf(fid, "R%d = %s(R%d, R%d)  !depth = %d\n",
-                  current_out_reg + ADD_IT, name.c_str(),
-                  invarnamelist[0] + ADD_IT, invarnamelist[1] + ADD_IT,
-                  output_depth);
+      // generate listing
+      fprintf(fid, "%s = %s(%s, %s)  !depth = %d\n", current_out_name.c_str(),
+              name.c_str(), invarnamelist[0].c_str(),
+              invarnamelist[1].c_str(), output_depth);
+      ckt.AddGate(GateEnum::XOR, {invarlist[0], invarlist[1]},
+                  current_out_node);
     } else if (name == "AND") {
-#if COMPUTE_DEPTH
-      // output depth  = max (input depths)+ 1
-      depth1 = depth_counter(invarnamelist(1));
-      depth2 = depth_counter(invarnamelist(2));
-      input_depth = max(max(depth1, depth2));
-
-      // adjust tower sizes if necessary
-      if (depth1 > depth2)
-        delta_depth = depth1 - depth2;
-      //                 fprintf(fid,"R%d = MREDUCE(R%d,%d)  !depth = %d\n",
-      //                 current_out_reg, name, invarnamelist(1),
-      //                 invarnamelist(2), output_depth);
-      fprintf(fid, "reduction of %d needed on first register\n", delta_depth);
-      elseif(depth2 > depth1) delta_depth = depth2 - depth1;
-      fprintf(fid, "reduction of %d needed on second register\n", delta_depth);
-      end
-          // adjust input depth
-          output_depth = input_depth + 1;
-#else
       output_depth = 1;
-#endif
       // generate listing
-      fprintf(fid, "R%d = %s(R%d, R%d) !depth = %d\n", current_out_reg + ADD_IT,
-              name.c_str(), invarnamelist[0] + ADD_IT,
-              invarnamelist[1] + ADD_IT, output_depth);
-#if COMPUTE_DEPTH
-      if (max_depth_required < output_depth) {
-        max_depth_required = output_depth;
-      }
-
-      if (output_depth == max_depth) {
-        // trigger a BOOTSTRAP
-        // find a new output register
-        // note, we do not incrememnt the register, since bootstrap
-        // is only a placeholder here.  We would need to flesh this
-        // out into more calls
-
-        fprintf(fid, "R%d = BOOT(R%d) !new depth = 0\n", current_out_reg,
-                current_out_reg);
-        output_depth = 0;
-        boot_counter = boot_counter + 1;
-      }
-      depth_counter[current_out_reg] = output_depth;
-#endif
+      fprintf(fid, "%s = %s(%s, %s) !depth = %d\n", current_out_name.c_str(),
+              name.c_str(), invarnamelist[0].c_str(),
+              invarnamelist[1].c_str(), output_depth);
+      ckt.AddGate(GateEnum::AND, {invarlist[0], invarlist[1]},
+                  current_out_node);
     } else if (name == "NOT") {
-#if COMPUTE_DEPTH
-      // output depth  = input depth
-      input_depth = depth_counter(invarnamelist(1));
-      output_depth = input_depth;
-      depth_counter(current_out_reg) = output_depth;
-#endif
       // generate listing
-      fprintf(fid, "R%d = %s(R%d) !depth = %d\n", current_out_reg + ADD_IT,
-              name.c_str(), invarnamelist[0] + ADD_IT, output_depth);
+      fprintf(fid, "%s = %s(%s) !depth = %d\n", current_out_name.c_str(),
+              name.c_str(), invarnamelist[0].c_str(), output_depth);
+      ckt.AddGate(GateEnum::NOT, {invarlist[0]}, current_out_node);
 
     } else {
       std::cout << "parse error on line :" << line_ix << std::endl;
       fprintf(fid, "#parse error on line %d\n", line_ix);
     }
+    depth_counter[current_out_node] = output_depth;
 
-    //  get the number of used (nonfalse) registers in the map for this line
-    active_reg_count[line_ix] =
-        std::count_if(reg_active_map.begin(), reg_active_map.end(),
-                      [](bool c) { return c != false; });
+    // a node that is never read frees its register right away
+    free_reg(current_out_node, line_ix);
 
     //  if it is a terminal output (i.e. one that gets read out of the alu
-    // out_ix = find(out_map == current_out_node);
-
-    auto it = std::find(out_map.begin(), out_map.end(), current_out_node);
-
-    if (it != out_map.end()) {
-      // std::cout << "Element " << invarlist[jx] <<" found at position : " ;
-      // std::cout << std::distance(out_map.begin(), it) << " (counting from
-      // zero) \n" ;
-
-      auto out_ix = std::distance(out_map.begin(), it);
+    if (current_out_node >= first_out_node) {
+      unsigned int out_ix = current_out_node - first_out_node;
 
       if (!delayed_get_flag) {
         // write out the STORE command right away.
-        fprintf(fid, "Out%ld = STORE(R%d) ! depth = %d\n", out_ix + ADD_IT,
-                current_out_reg + ADD_IT,
+        fprintf(fid, "Out%d = STORE(%s) ! depth = %d\n", out_ix + ADD_IT,
+                current_out_name.c_str(),
                 output_depth); // get the appropriate output
+        ckt.AddOutput(0, out_ix, current_out_node);
       } else {
         // otherwise make a commend and mark it for output at the end of
         // program
-        fprintf(fid, "# R%d is a terminal output register for out%ld\n",
-                current_out_reg + ADD_IT, out_ix + ADD_IT);
-        out_reg_map[out_ix] = current_out_reg; // #ok
+        fprintf(fid, "# %s is a terminal output register for out%d\n",
+                current_out_name.c_str(), out_ix + ADD_IT);
       }
     }
 
@@ -408,22 +322,36 @@ void assemble_bristol(Analysis &analysis, unsigned int max_depth,
   //  clean up by writing outputs if necessary
   if (delayed_get_flag) {
     // get all terminal outputs
-    for (uint ix = 0; ix < out_map.size(); ix++) {
-      fprintf(fid, "Out%d = STORE(R%d) ! depth = %d\n", ix + ADD_IT,
-              out_reg_map[ix] + ADD_IT,
-              depth_counter[out_reg_map[ix]]); // get the appropriate output
+    for (uint ix = 0; ix < v.n_out1_bits; ix++) {
+      unsigned int node = first_out_node + ix;
+      if (node_reg_map[node] < 0) {
+        std::cout << "output node " << node
+                  << " was never assigned! fatal error, exiting!" << std::endl;
+        exit(-1);
+      }
+      fprintf(fid, "Out%d = STORE(%s) ! depth = %d\n", ix + ADD_IT,
+              reg_name(node).c_str(),
+              depth_counter[node]); // get the appropriate output
+      ckt.AddOutput(0, ix, node);
     }
   }
 
   //  write out statistics
   fprintf(fid, "# Assembler statistics\n");
   fprintf(fid, "# max depth supported: %d\n", max_depth);
-  fprintf(fid, "# max depth required: %d\n", max_depth_required);
-  fprintf(fid, "# max tower jump: %d\n", max_tower_jump);
   fprintf(fid, "# %d registers used\n",
-          *max_element(active_reg_count.begin(), active_reg_count.end()));
-  fprintf(fid, "# %d BOOT operations required\n", boot_counter);
+          static_cast<unsigned int>(reg_ver_count.size()));
 
   //  Close output file
   fclose(fid);
+
+  if (binary_flag) {
+    ckt.GenerateFanout();
+    std::string cktFname = cktFileName(fname);
+    std::cout << "Assembler: writing compiled circuit " << cktFname
+              << std::endl;
+    if (!ckt.Write(cktFname)) {
+      std::cout << "error writing compiled circuit" << std::endl;
+    }
+  }
 }
@@ -41,6 +41,6 @@
 
 // function declaration
 void assemble_bristol(Analysis &analysis, unsigned int max_depth,
-                      bool debug_flag);
+                      bool debug_flag, bool binary_flag = false);
 
 #endif
@@ -0,0 +1,126 @@
+// @file busfile.cpp -- files of encrypted input and output buses
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other
+// contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+#include "busfile.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "binfhecontext-ser.h"
+
+bool WriteBusFile(std::string fname, const std::vector<CipherTextList> &buses) {
+  std::ofstream outFile(fname, std::ios::binary);
+  if (!outFile) {
+    std::cerr << "error opening bus file " << fname << " for output"
+              << std::endl;
+    return false;
+  }
+  BusFileHeader h;
+  std::memset(&h, 0, sizeof(h));
+  std::memcpy(h.magic, BUS_FILE_MAGIC, sizeof(h.magic));
+  h.version = BUS_FILE_VERSION;
+  h.n_buses = buses.size();
+  outFile.write(reinterpret_cast<const char *>(&h), sizeof(h));
+  for (auto const &bus : buses) {
+    uint32_t n_bits = bus.size();
+    outFile.write(reinterpret_cast<const char *>(&n_bits), sizeof(n_bits));
+  }
+  for (auto const &bus : buses) {
+    for (auto const &ct : bus) {
+      uint8_t present = (ct != nullptr);
+      outFile.write(reinterpret_cast<const char *>(&present),
+                    sizeof(present));
+      if (present) {
+        lbcrypto::Serial::Serialize(ct, outFile, lbcrypto::SerType::BINARY);
+      }
+    }
+  }
+  outFile.close();
+  if (!outFile) {
+    std::cerr << "error writing bus file " << fname << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool ReadBusFile(std::string fname, std::vector<CipherTextList> *buses) {
+  std::ifstream inFile(fname, std::ios::binary);
+  if (!inFile) {
+    std::cerr << "error opening bus file " << fname << std::endl;
+    return false;
+  }
+  BusFileHeader h;
+  if (!inFile.read(reinterpret_cast<char *>(&h), sizeof(h)) ||
+      std::memcmp(h.magic, BUS_FILE_MAGIC, sizeof(h.magic)) != 0) {
+    std::cerr << fname << " is not a bus file" << std::endl;
+    return false;
+  }
+  if (h.version != BUS_FILE_VERSION) {
+    std::cerr << "bus file " << fname << " is version " << h.version
+              << ", expected " << BUS_FILE_VERSION << std::endl;
+    return false;
+  }
+  std::vector<uint32_t> bus_bits(h.n_buses);
+  if (!inFile.read(reinterpret_cast<char *>(bus_bits.data()),
+                   bus_bits.size() * sizeof(uint32_t))) {
+    std::cerr << "bus file " << fname << " is truncated" << std::endl;
+    return false;
+  }
+  buses->resize(h.n_buses);
+  try {
+    for (uint32_t bix = 0; bix < h.n_buses; bix++) {
+      auto &bus = (*buses)[bix];
+      bus.assign(bus_bits[bix], CipherText());
+      for (auto &ct : bus) {
+        uint8_t present;
+        if (!inFile.read(reinterpret_cast<char *>(&present),
+                         sizeof(present))) {
+          std::cerr << "bus file " << fname << " is truncated" << std::endl;
+          return false;
+        }
+        if (present) {
+          lbcrypto::Serial::Deserialize(ct, inFile,
+                                        lbcrypto::SerType::BINARY);
+        }
+      }
+    }
+  } catch (...) {
+    std::cerr << "error reading ciphertext from bus file " << fname
+              << std::endl;
+    return false;
+  }
+  return true;
+}
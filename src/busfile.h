@@ -0,0 +1,75 @@
+// @file busfile.h -- files of encrypted input and output buses
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other
+// contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+#ifndef SRC_BUSFILE_H_
+#define SRC_BUSFILE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gate.h"
+
+// An encrypted bus file (*.ebus) holds the ciphertexts of the input or
+// output buses of one evaluation, so a client can encrypt its inputs,
+// ship them to an evaluator that holds no secret key, and decrypt the
+// outputs it gets back.
+//
+// Layout (fields are native endian 32 bit unsigned unless noted):
+//   BusFileHeader
+//   bus_bits[n_buses]              number of bits of each bus
+//   then for every bit of every bus, bus 0 bit 0 first:
+//     uint8_t present              0 if the ciphertext is missing (a
+//                                  gate that failed on the evaluator)
+//     ciphertext                   OpenFHE binary serialization, only
+//                                  if present
+//
+// The ciphertexts are serialized straight to and from the file stream,
+// one at a time. Bump BUS_FILE_VERSION whenever the layout changes.
+
+const char BUS_FILE_MAGIC[8] = {'O', 'E', 'C', 'E', 'B', 'U', 'S', '\0'};
+const uint32_t BUS_FILE_VERSION = 1;
+
+struct BusFileHeader {
+  char magic[8];    // BUS_FILE_MAGIC
+  uint32_t version; // BUS_FILE_VERSION
+  uint32_t n_buses; // number of buses
+};
+
+// function declaration
+bool WriteBusFile(std::string fname, const std::vector<CipherTextList> &buses);
+bool ReadBusFile(std::string fname, std::vector<CipherTextList> *buses);
+
+#endif // SRC_BUSFILE_H_
@@ -0,0 +1,168 @@
+// @file chain.cpp -- chains of circuits joined on encrypted buses
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other
+// contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+#include "chain.h"
+
+#include <cstdlib>
+#include <iostream>
+
+#include "cktfile.h"
+
+CircuitChain::CircuitChain(void) {}
+
+unsigned int
+CircuitChain::AddStage(std::shared_ptr<const CompiledCircuit> ckt) {
+  // append a circuit to the chain, returns its stage number
+  this->stages.push_back(ckt);
+  auto n_inputs = ckt->getInputBits().size();
+  this->srcStage.push_back(std::vector<unsigned int>(n_inputs, NOT_BOUND));
+  this->srcBus.push_back(std::vector<unsigned int>(n_inputs, NOT_BOUND));
+  return this->stages.size() - 1;
+}
+
+void CircuitChain::Bind(unsigned int stage, unsigned int in_bus,
+                        unsigned int src_stage, unsigned int out_bus) {
+  // feed input bus in_bus of stage from output bus out_bus of src_stage,
+  // which must be an earlier stage
+  if ((stage >= this->stages.size()) || (src_stage >= stage)) {
+    std::cerr << "Error cannot bind stage " << stage << " to stage "
+              << src_stage << std::endl;
+    exit(-1);
+  }
+  auto in_bits = this->stages[stage]->getInputBits();
+  auto const &out_bits = this->stages[src_stage]->n_output_bits;
+  if ((in_bus >= in_bits.size()) || (out_bus >= out_bits.size()) ||
+      (in_bits[in_bus] != out_bits[out_bus])) {
+    std::cerr << "Error cannot bind input " << in_bus << " of stage "
+              << stage << " to output " << out_bus << " of stage "
+              << src_stage << std::endl;
+    exit(-1);
+  }
+  this->srcStage[stage][in_bus] = src_stage;
+  this->srcBus[stage][in_bus] = out_bus;
+}
+
+std::shared_ptr<const CompiledCircuit> CircuitChain::Compile(void) const {
+  // output buses that feed a later stage are not outputs of the chain
+  std::vector<std::vector<bool>> consumed(this->stages.size());
+  for (unsigned int six = 0; six < this->stages.size(); six++) {
+    consumed[six].assign(this->stages[six]->n_outputs, false);
+  }
+  for (unsigned int six = 0; six < this->stages.size(); six++) {
+    for (unsigned int bus = 0; bus < this->srcStage[six].size(); bus++) {
+      if (this->srcStage[six][bus] != NOT_BOUND) {
+        consumed[this->srcStage[six][bus]][this->srcBus[six][bus]] = true;
+      }
+    }
+  }
+
+  // the wires of each stage are moved past those of the earlier stages,
+  // except the bound input wires, which become the wires that drove the
+  // output bits they are bound to
+  CktFile chain;
+  chain.n_wires = 0;
+  unsigned int ext_in = 0;
+  unsigned int ext_out = 0;
+  // for each stage, output bus and bit, the chain wire that drives it
+  std::vector<std::vector<std::vector<unsigned int>>> outWire(
+      this->stages.size());
+  for (unsigned int six = 0; six < this->stages.size(); six++) {
+    auto const &ckt = *this->stages[six];
+    unsigned int offset = chain.n_wires;
+    std::vector<unsigned int> wireMap(ckt.n_wires);
+    for (unsigned int wid = 0; wid < ckt.n_wires; wid++) {
+      wireMap[wid] = offset + wid;
+    }
+
+    // input buses, numbered after the unbound buses of earlier stages
+    auto n_inputs = this->srcStage[six].size();
+    std::vector<unsigned int> busMap(n_inputs);
+    for (unsigned int bus = 0; bus < n_inputs; bus++) {
+      if (this->srcStage[six][bus] == NOT_BOUND) {
+        busMap[bus] = ext_in++;
+      }
+    }
+    for (auto const &g : ckt.inputGates) {
+      auto bus = g.bus;
+      auto bit = g.bit;
+      auto src = this->srcStage[six][bus];
+      if (src == NOT_BOUND) {
+        chain.AddInput(busMap[bus], bit, wireMap[g.outWires[0]]);
+      } else {
+        wireMap[g.outWires[0]] = outWire[src][this->srcBus[six][bus]][bit];
+      }
+    }
+
+    outWire[six].resize(ckt.n_outputs);
+    for (unsigned int bus = 0; bus < ckt.n_outputs; bus++) {
+      outWire[six][bus].assign(ckt.n_output_bits[bus], 0);
+    }
+    std::vector<unsigned int> outBusMap(ckt.n_outputs);
+    for (unsigned int bus = 0; bus < ckt.n_outputs; bus++) {
+      if (!consumed[six][bus]) {
+        outBusMap[bus] = ext_out++;
+      }
+    }
+    for (auto const &g : ckt.allGates) {
+      std::vector<uint32_t> in;
+      for (auto wid : g.inWires) {
+        in.push_back(wireMap[wid]);
+      }
+      if (g.op == GateEnum::OUTPUT) {
+        auto bus = g.bus;
+        auto bit = g.bit;
+        outWire[six][bus][bit] = in[0];
+        if (!consumed[six][bus]) {
+          chain.AddOutput(outBusMap[bus], bit, in[0]);
+        }
+      } else if ((g.op == GateEnum::LUT3) || (g.op == GateEnum::LUT4)) {
+        chain.AddLut(g.op, in, g.table, wireMap[g.outWires[0]]);
+      } else {
+        chain.AddGate(g.op, in, wireMap[g.outWires[0]]);
+      }
+    }
+    chain.n_wires = offset + ckt.n_wires;
+  }
+  chain.GenerateFanout();
+
+  auto compiled = std::make_shared<CompiledCircuit>();
+  if (!compiled->LoadCkt(chain.View())) {
+    std::cerr << "Error compiling circuit chain" << std::endl;
+    exit(-1);
+  }
+  std::cout << "chained " << this->stages.size() << " circuits into "
+            << compiled->allGates.size() << " gates" << std::endl;
+  return compiled;
+}
@@ -0,0 +1,73 @@
+// @file chain.h -- chains of circuits joined on encrypted buses
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other
+// contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+#ifndef SRC_CHAIN_H_
+#define SRC_CHAIN_H_
+
+#include <memory>
+#include <vector>
+
+#include "compiled.h"
+
+// A chain of circuits, such as key schedule -> AES rounds -> comparator,
+// where input buses of later stages are bound to output buses of earlier
+// ones. Compile() splices the stages into one CompiledCircuit in which a
+// bound input bit is the same wire as the output bit it is bound to, so
+// the ciphertext is passed along by handle with no copy, decryption or
+// re-encryption, and the gates of a later stage start as soon as the
+// bits they need are ready instead of after the whole earlier stage.
+//
+// The buses of the chained circuit are numbered in stage order:
+//   inputs  every input bus that is not bound, stage 0 first
+//   outputs every output bus that no input is bound to, stage 0 first
+class CircuitChain {
+public:
+  CircuitChain();
+  unsigned int AddStage(std::shared_ptr<const CompiledCircuit> ckt);
+  void Bind(unsigned int stage, unsigned int in_bus, unsigned int src_stage,
+            unsigned int out_bus);
+  std::shared_ptr<const CompiledCircuit> Compile(void) const;
+
+private:
+  std::vector<std::shared_ptr<const CompiledCircuit>> stages;
+
+  // for each stage and input bus, the stage and output bus it is bound
+  // to, or NOT_BOUND
+  static const unsigned int NOT_BOUND = ~0u;
+  std::vector<std::vector<unsigned int>> srcStage;
+  std::vector<std::vector<unsigned int>> srcBus;
+};
+
+#endif // SRC_CHAIN_H_
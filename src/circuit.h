@@ -32,32 +32,41 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 //==================================================================================
+
 #ifndef SRC_CIRCUIT_EVAL_H_
 #define SRC_CIRCUIT_EVAL_H_
 
-#include <algorithm>
-#include <deque>
+#include <memory>
 #include <string>
 #include <vector>
 
-#include "gate.h"
-#include "wire.h"
-
-using GateNameList = std::vector<std::string>;
-using GateList = std::vector<Gate>;
-using GateQueue = std::deque<Gate>;
-
-using Inputs = std::vector<std::vector<unsigned int>>;
-using Outputs = std::vector<std::vector<unsigned int>>;
-using NetList = std::map<std::string, GateNameList>;
-
+#include "client.h"
+#include "compiled.h"
+#include "evaluation.h"
+#include "executor.h"
+
+// A circuit with its keys and one evaluation state. The loaded circuit is
+// a CompiledCircuit that is never changed by evaluation, so further
+// EvaluationStates made with NewEvaluationState() can evaluate it at the
+// same time on other threads. Circuits made from one CircuitClient share
+// its context and bootstrapping keys, so the key memory does not grow
+// with the number of circuits.
+//
+// A new circuit uses the DYNAMIC schedule and the OMP executor, the test
+// benches pass the ones picked with -l and -e to setSchedule() and
+// setExecutor().
 class Circuit {
 public:
-  Circuit(lbcrypto::BINFHE_PARAMSET set, lbcrypto::BINFHE_METHOD method);
+  Circuit(lbcrypto::BINFHE_PARAMSET set, lbcrypto::BINFHE_METHOD method,
+          std::string keyStore = "");
+  explicit Circuit(std::shared_ptr<const CircuitClient> keys);
   ~Circuit();
   bool ReadFile(std::string cktName);
+  bool ReadBristolFile(std::string cktName, bool new_flag = true);
+  bool WriteCktFile(std::string cktName);
   void Reset(void);
   void SetInput(Inputs input, bool verbose = false);
+  void SetEncryptedInput(const EncInputs &input);
   std::string Evaluate(void);
   void setPlaintext(bool);
   bool getPlaintext(void);
@@ -65,52 +74,46 @@ public:
   bool getEncrypted(void);
   void setVerify(bool);
   bool getVerify(void);
+  void setSchedule(ScheduleEnum);
+  ScheduleEnum getSchedule(void);
+  void setExecutor(ExecutorEnum);
+  ExecutorEnum getExecutor(void);
+  void setOutputCallback(OutputCallback);
+  void setProgress(bool);
+  void setXorMode(XorEnum);
+  XorEnum getXorMode(void);
+  unsigned int getMismatches(GateEnum op);
   Outputs Clock(void);
+  EncOutputs getEncryptedOutputs(void);
+  std::vector<Outputs> EvaluateBatch(std::vector<Inputs> inputs);
+  std::vector<unsigned int> getInputBits(void);
+
+  void setCompiledCircuit(std::shared_ptr<const CompiledCircuit>);
+  std::shared_ptr<const CompiledCircuit> getCompiledCircuit(void);
+  // n_states is how many states will run at once, they split the cores
+  std::unique_ptr<EvaluationState>
+  NewEvaluationState(unsigned int n_states = 1);
 
   void dumpNetList(void);
   void dumpGates(void);
   void dumpGateCount(void);
 
 private:
+  std::shared_ptr<const CircuitClient> client; // may be shared
   lbcrypto::BinFHEContext cc;
   lbcrypto::LWEPrivateKey sk;
 
-  bool plaintext_flag; // if true perform plaintext logic
-  bool encrypted_flag; // if true perform encrypted logic
-  bool verify_flag;    // if true verify plaintext vs encrypted logic
-
-  NetList nl; // full net list of the ckt (all wires and fanout gates)
-
-  WireNameList waitingWireNames;
-  WireQueue activeWires;
-
-  GateList inputGates; // input gates in ckt
-  GateList allGates;   // all other gates in ckt
-
-  GateQueue readyGates;
-  GateQueue waitingGates;
-  GateQueue executingGates;
-  GateQueue examinedGates;
-  GateQueue doneGates;
-  bool done;
-
-  bool _parse_input(Inputs, std::string, std::string);
-  void _parse_output(std::string, std::string, bool);
-  void _CircuitManager(void);
-  void _ExecuteGates(void);
-
-  GateEvalParams gep;
+  ScheduleEnum schedule;
+  ExecutorEnum executor_kind;
+  std::shared_ptr<Executor> executor; // runs the gates of every schedule
+  OutputCallback outputCallback;
+  bool progress; // shown for the state of the circuit, not for new ones
+  XorEnum xor_mode;
 
-  unsigned int n_outputs;
-  std::vector<unsigned int> n_output_bits;
-  Outputs circuitOut;
+  std::shared_ptr<const CompiledCircuit> ckt; // the loaded circuit
+  std::unique_ptr<EvaluationState> state;     // used by Reset() .. Clock()
 
-  unsigned int n_input_gates;
-  unsigned int n_output_gates;
-  unsigned int n_and_gates;
-  unsigned int n_or_gates;
-  unsigned int n_xor_gates;
-  unsigned int n_not_gates;
+  void _Load(std::shared_ptr<const CompiledCircuit>);
 };
 
 #endif
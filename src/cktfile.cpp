@@ -0,0 +1,596 @@
+// @file cktfile.cpp -- compiled binary circuit file format
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other
+// contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+#include "cktfile.h"
+
+#include <fcntl.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+CktFile::CktFile(void) : n_wires(0) {}
+
+void CktFile::AddInput(uint32_t bus, uint32_t bit, uint32_t wire) {
+  CktFileGate g;
+  std::memset(&g, 0, sizeof(g));
+  g.op = static_cast<uint32_t>(GateEnum::INPUT);
+  g.n_in = 0;
+  for (uint32_t ix = 0; ix < CKT_FILE_MAX_IN; ix++) {
+    g.in[ix] = CKT_FILE_NONE;
+  }
+  g.out = wire;
+  g.bus = bus;
+  g.bit = bit;
+  this->input_gates.push_back(g);
+
+  if (this->in_bits.size() <= bus) {
+    this->in_bits.resize(bus + 1, 0);
+  }
+  this->in_bits[bus] = std::max(this->in_bits[bus], bit + 1);
+  this->n_wires = std::max(this->n_wires, wire + 1);
+}
+
+void CktFile::AddGate(GateEnum op, std::vector<uint32_t> in, uint32_t wire) {
+  CktFileGate g;
+  std::memset(&g, 0, sizeof(g));
+  g.op = static_cast<uint32_t>(op);
+  g.n_in = in.size();
+  for (uint32_t ix = 0; ix < CKT_FILE_MAX_IN; ix++) {
+    g.in[ix] = (ix < in.size()) ? in[ix] : CKT_FILE_NONE;
+    if (ix < in.size()) {
+      this->n_wires = std::max(this->n_wires, in[ix] + 1);
+    }
+  }
+  g.out = wire;
+  g.bus = CKT_FILE_NONE;
+  g.bit = CKT_FILE_NONE;
+  this->gates.push_back(g);
+  if (wire != CKT_FILE_NONE) {
+    this->n_wires = std::max(this->n_wires, wire + 1);
+  }
+}
+
+void CktFile::AddOutput(uint32_t bus, uint32_t bit, uint32_t wire) {
+  this->AddGate(GateEnum::OUTPUT, std::vector<uint32_t>(1, wire),
+                CKT_FILE_NONE);
+  this->gates.back().bus = bus;
+  this->gates.back().bit = bit;
+
+  if (this->out_bits.size() <= bus) {
+    this->out_bits.resize(bus + 1, 0);
+  }
+  this->out_bits[bus] = std::max(this->out_bits[bus], bit + 1);
+}
+
+void CktFile::AddLut(GateEnum op, std::vector<uint32_t> in, uint32_t table,
+                     uint32_t wire) {
+  this->AddGate(op, in, wire);
+  this->gates.back().bus = table;
+}
+
+void CktFile::GenerateFanout(void) {
+  // build the CSR fanout table from the gate input lists with a counting
+  // pass followed by a fill pass, listing each gate once per wire.
+  this->fanout_start.assign(this->n_wires + 1, 0);
+  for (uint32_t gix = 0; gix < this->gates.size(); gix++) {
+    const CktFileGate &g = this->gates[gix];
+    for (uint32_t ix = 0; ix < g.n_in; ix++) {
+      bool first(true);
+      for (uint32_t jx = 0; jx < ix; jx++) {
+        first &= (g.in[jx] != g.in[ix]);
+      }
+      if (first) {
+        this->fanout_start[g.in[ix] + 1]++;
+      }
+    }
+  }
+  for (uint32_t wid = 0; wid < this->n_wires; wid++) {
+    this->fanout_start[wid + 1] += this->fanout_start[wid];
+  }
+  this->fanout_gates.assign(this->fanout_start[this->n_wires], 0);
+  std::vector<uint32_t> next(this->fanout_start.begin(),
+                             this->fanout_start.end() - 1);
+  for (uint32_t gix = 0; gix < this->gates.size(); gix++) {
+    const CktFileGate &g = this->gates[gix];
+    for (uint32_t ix = 0; ix < g.n_in; ix++) {
+      bool first(true);
+      for (uint32_t jx = 0; jx < ix; jx++) {
+        first &= (g.in[jx] != g.in[ix]);
+      }
+      if (first) {
+        this->fanout_gates[next[g.in[ix]]++] = gix;
+      }
+    }
+  }
+}
+
+// append a vector's raw bytes to a byte buffer
+template <typename T>
+static void append_bytes(std::vector<unsigned char> &buf,
+                         const std::vector<T> &v) {
+  const unsigned char *p = reinterpret_cast<const unsigned char *>(v.data());
+  buf.insert(buf.end(), p, p + v.size() * sizeof(T));
+}
+
+CktView CktFile::View(void) {
+  if (this->fanout_start.size() != this->n_wires + 1) {
+    this->GenerateFanout();
+  }
+  CktView v;
+  v.n_inputs = this->in_bits.size();
+  v.n_outputs = this->out_bits.size();
+  v.n_input_gates = this->input_gates.size();
+  v.n_gates = this->gates.size();
+  v.n_wires = this->n_wires;
+  v.n_fanout = this->fanout_gates.size();
+  v.in_bits = this->in_bits.data();
+  v.out_bits = this->out_bits.data();
+  v.input_gates = this->input_gates.data();
+  v.gates = this->gates.data();
+  v.fanout_start = this->fanout_start.data();
+  v.fanout_gates = this->fanout_gates.data();
+  return v;
+}
+
+bool CktFile::Write(std::string fname) {
+  if (this->fanout_start.size() != this->n_wires + 1) {
+    this->GenerateFanout();
+  }
+
+  CktFileHeader h;
+  std::memset(&h, 0, sizeof(h));
+  std::memcpy(h.magic, CKT_FILE_MAGIC, sizeof(h.magic));
+  h.version = CKT_FILE_VERSION;
+  h.n_inputs = this->in_bits.size();
+  h.n_outputs = this->out_bits.size();
+  h.n_input_gates = this->input_gates.size();
+  h.n_gates = this->gates.size();
+  h.n_wires = this->n_wires;
+  h.n_fanout = this->fanout_gates.size();
+
+  std::vector<unsigned char> body;
+  append_bytes(body, this->in_bits);
+  append_bytes(body, this->out_bits);
+  append_bytes(body, this->input_gates);
+  append_bytes(body, this->gates);
+  append_bytes(body, this->fanout_start);
+  append_bytes(body, this->fanout_gates);
+  h.checksum = cktChecksum(body.data(), body.size());
+
+  FILE *fid = fopen(fname.c_str(), "wb");
+  if (fid == NULL) {
+    std::cerr << "error opening compiled circuit file " << fname
+              << " for output" << std::endl;
+    return false;
+  }
+  bool ok = (fwrite(&h, sizeof(h), 1, fid) == 1);
+  ok &= (fwrite(body.data(), 1, body.size(), fid) == body.size());
+  ok &= (fclose(fid) == 0);
+  if (!ok) {
+    std::cerr << "error writing compiled circuit file " << fname << std::endl;
+  }
+  return ok;
+}
+
+bool CktFile::ReadBristol(std::string fname, bool new_flag) {
+  // compile a Bristol Fashion circuit file directly, without going
+  // through analyze_bristol() and the .out assembler listing.
+  //
+  // old format header:       new format header:
+  //   n_gates n_wires          n_gates n_wires
+  //   n_in1 n_in2 n_out1       n_in n_in1 ... n_inN
+  //                            n_out n_out1 ... n_outM
+  // the input wires are numbered first, input 1 bit 0 is wire 0, and the
+  // output wires are the last wires. Each gate line is
+  //   n_in n_out in_wire ... out_wire ... OP
+  // with OP one of XOR AND INV EQW MAND. EQW copies a wire, so its
+  // output is made an alias of its input. MAND is n_out parallel ANDs.
+
+  TextFileMap in;
+  if (!in.Open(fname)) {
+    return false;
+  }
+
+  *this = CktFile();
+  uint32_t n_gates, n_bristol_wires;
+  bool ok = in.NextUint(&n_gates) && in.NextUint(&n_bristol_wires);
+  std::vector<uint32_t> in_sizes;
+  std::vector<uint32_t> out_sizes;
+  if (new_flag) {
+    uint32_t n_in, n_out, tmp;
+    ok = ok && in.NextUint(&n_in);
+    for (uint32_t ix = 0; ok && (ix < n_in); ix++) {
+      ok = in.NextUint(&tmp);
+      in_sizes.push_back(tmp);
+    }
+    ok = ok && in.NextUint(&n_out);
+    for (uint32_t ix = 0; ok && (ix < n_out); ix++) {
+      ok = in.NextUint(&tmp);
+      out_sizes.push_back(tmp);
+    }
+  } else {
+    uint32_t n_in1, n_in2, n_out1;
+    ok = ok && in.NextUint(&n_in1) && in.NextUint(&n_in2) &&
+         in.NextUint(&n_out1);
+    in_sizes.push_back(n_in1);
+    if (n_in2 > 0) {
+      in_sizes.push_back(n_in2);
+    }
+    out_sizes.push_back(n_out1);
+  }
+  if (!ok) {
+    std::cerr << "error parsing header of Bristol file " << fname
+              << std::endl;
+    return false;
+  }
+
+  // the input bits are the first wires and the output bits the last
+  uint64_t n_in_wires = 0;
+  uint64_t n_out_wires = 0;
+  for (auto n : in_sizes) {
+    n_in_wires += n;
+  }
+  for (auto n : out_sizes) {
+    n_out_wires += n;
+  }
+  if ((n_in_wires > n_bristol_wires) || (n_out_wires > n_bristol_wires)) {
+    std::cerr << "Bristol file " << fname << " has more input or output "
+              << "bits than its " << n_bristol_wires << " wires" << std::endl;
+    return false;
+  }
+
+  // alias[w] is the wire that actually carries the value of wire w
+  std::vector<uint32_t> alias(n_bristol_wires);
+  for (uint32_t wid = 0; wid < n_bristol_wires; wid++) {
+    alias[wid] = wid;
+  }
+
+  uint32_t wire = 0;
+  for (uint32_t bus = 0; bus < in_sizes.size(); bus++) {
+    for (uint32_t bit = 0; bit < in_sizes[bus]; bit++) {
+      this->AddInput(bus, bit, wire++);
+    }
+  }
+
+  // EQ gates set a wire to a constant. There are no constant gates, so
+  // constant[0] = XOR(w, w) and constant[1] = NOT(constant[0]) of the
+  // first input wire w are made on first use, on wires after the Bristol
+  // ones
+  uint32_t n_const_wires = 0;
+  uint32_t constant[2] = {CKT_FILE_NONE, CKT_FILE_NONE};
+
+  std::vector<uint32_t> wires;
+  for (uint32_t line = 0; line < n_gates; line++) {
+    uint32_t nin, nout;
+    const char *tok;
+    size_t len;
+    ok = in.NextUint(&nin) && in.NextUint(&nout);
+    wires.resize(nin + nout);
+    for (uint32_t ix = 0; ok && (ix < nin + nout); ix++) {
+      ok = in.NextUint(&wires[ix]) && (wires[ix] < n_bristol_wires);
+    }
+    ok = ok && in.NextToken(&tok, &len);
+    if (!ok) {
+      std::cerr << "error parsing gate " << line << " of Bristol file "
+                << fname << std::endl;
+      return false;
+    }
+    bool is_eq = tokenIs(tok, len, "EQ");
+    for (uint32_t ix = 0; !is_eq && (ix < nin); ix++) {
+      wires[ix] = alias[wires[ix]];
+    }
+
+    if (tokenIs(tok, len, "XOR") && (nin == 2) && (nout == 1)) {
+      this->AddGate(GateEnum::XOR, {wires[0], wires[1]}, wires[2]);
+    } else if (tokenIs(tok, len, "AND") && (nin == 2) && (nout == 1)) {
+      this->AddGate(GateEnum::AND, {wires[0], wires[1]}, wires[2]);
+    } else if (tokenIs(tok, len, "INV") && (nin == 1) && (nout == 1)) {
+      this->AddGate(GateEnum::NOT, {wires[0]}, wires[1]);
+    } else if (tokenIs(tok, len, "EQW") && (nin == 1) && (nout == 1)) {
+      alias[wires[1]] = wires[0];
+    } else if (is_eq && (nin == 1) && (nout == 1) && (wires[0] < 2) &&
+               (n_in_wires > 0)) {
+      if (constant[0] == CKT_FILE_NONE) {
+        constant[0] = n_bristol_wires + n_const_wires++;
+        this->AddGate(GateEnum::XOR, {0, 0}, constant[0]);
+      }
+      if ((wires[0] == 1) && (constant[1] == CKT_FILE_NONE)) {
+        constant[1] = n_bristol_wires + n_const_wires++;
+        this->AddGate(GateEnum::NOT, {constant[0]}, constant[1]);
+      }
+      alias[wires[1]] = constant[wires[0]];
+    } else if (tokenIs(tok, len, "MAND") && (nin == 2 * nout)) {
+      for (uint32_t ix = 0; ix < nout; ix++) {
+        this->AddGate(GateEnum::AND, {wires[ix], wires[nout + ix]},
+                      wires[nin + ix]);
+      }
+    } else {
+      std::cerr << "cannot compile gate " << std::string(tok, len)
+                << " on gate " << line << " of Bristol file " << fname
+                << std::endl;
+      return false;
+    }
+  }
+
+  wire = n_bristol_wires - static_cast<uint32_t>(n_out_wires);
+  for (uint32_t bus = 0; bus < out_sizes.size(); bus++) {
+    for (uint32_t bit = 0; bit < out_sizes[bus]; bit++) {
+      this->AddOutput(bus, bit, alias[wire++]);
+    }
+  }
+  this->n_wires = std::max(this->n_wires, n_bristol_wires + n_const_wires);
+  this->GenerateFanout();
+  return true;
+}
+
+CktView::CktView(void)
+    : n_inputs(0), n_outputs(0), n_input_gates(0), n_gates(0), n_wires(0),
+      n_fanout(0), in_bits(NULL), out_bits(NULL), input_gates(NULL),
+      gates(NULL), fanout_start(NULL), fanout_gates(NULL) {}
+
+CktFileMap::CktFileMap(void) : CktView(), addr(NULL), len(0) {}
+
+CktFileMap::~CktFileMap(void) { this->Close(); }
+
+void CktFileMap::Close(void) {
+  if (this->addr != NULL) {
+    munmap(this->addr, this->len);
+  }
+  this->addr = NULL;
+  this->len = 0;
+  *static_cast<CktView *>(this) = CktView();
+}
+
+bool CktFileMap::Open(std::string fname) {
+  // map the file read only and point each section into the mapping
+  this->Close();
+  int fd = open(fname.c_str(), O_RDONLY);
+  if (fd < 0) {
+    std::cerr << "error opening compiled circuit file " << fname << std::endl;
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(CktFileHeader)) {
+    std::cerr << "compiled circuit file " << fname << " is truncated"
+              << std::endl;
+    close(fd);
+    return false;
+  }
+  this->len = st.st_size;
+  this->addr = mmap(NULL, this->len, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (this->addr == MAP_FAILED) {
+    std::cerr << "error mapping compiled circuit file " << fname << std::endl;
+    this->addr = NULL;
+    this->len = 0;
+    return false;
+  }
+
+  const unsigned char *base = static_cast<const unsigned char *>(this->addr);
+  const CktFileHeader *h = reinterpret_cast<const CktFileHeader *>(base);
+  if (std::memcmp(h->magic, CKT_FILE_MAGIC, sizeof(h->magic)) != 0) {
+    std::cerr << fname << " is not a compiled circuit file" << std::endl;
+    this->Close();
+    return false;
+  }
+  if (h->version != CKT_FILE_VERSION) {
+    std::cerr << "compiled circuit file " << fname << " is version "
+              << h->version << ", expected " << CKT_FILE_VERSION << std::endl;
+    this->Close();
+    return false;
+  }
+  size_t expected = sizeof(CktFileHeader) +
+                    sizeof(uint32_t) * (size_t(h->n_inputs) + h->n_outputs) +
+                    sizeof(CktFileGate) * (size_t(h->n_input_gates) +
+                                           h->n_gates) +
+                    sizeof(uint32_t) * (size_t(h->n_wires) + 1 + h->n_fanout);
+  if (expected != this->len) {
+    std::cerr << "compiled circuit file " << fname << " has bad length"
+              << std::endl;
+    this->Close();
+    return false;
+  }
+  const unsigned char *p = base + sizeof(CktFileHeader);
+  if (cktChecksum(p, this->len - sizeof(CktFileHeader)) != h->checksum) {
+    std::cerr << "compiled circuit file " << fname << " has bad checksum"
+              << std::endl;
+    this->Close();
+    return false;
+  }
+
+  this->n_inputs = h->n_inputs;
+  this->n_outputs = h->n_outputs;
+  this->n_input_gates = h->n_input_gates;
+  this->n_gates = h->n_gates;
+  this->n_wires = h->n_wires;
+  this->n_fanout = h->n_fanout;
+  this->in_bits = reinterpret_cast<const uint32_t *>(p);
+  p += sizeof(uint32_t) * h->n_inputs;
+  this->out_bits = reinterpret_cast<const uint32_t *>(p);
+  p += sizeof(uint32_t) * h->n_outputs;
+  this->input_gates = reinterpret_cast<const CktFileGate *>(p);
+  p += sizeof(CktFileGate) * h->n_input_gates;
+  this->gates = reinterpret_cast<const CktFileGate *>(p);
+  p += sizeof(CktFileGate) * h->n_gates;
+  this->fanout_start = reinterpret_cast<const uint32_t *>(p);
+  p += sizeof(uint32_t) * (h->n_wires + 1);
+  this->fanout_gates = reinterpret_cast<const uint32_t *>(p);
+  return true;
+}
+
+TextFileMap::TextFileMap(void) : addr(NULL), len(0), p(NULL), end(NULL) {}
+
+TextFileMap::~TextFileMap(void) { this->Close(); }
+
+void TextFileMap::Close(void) {
+  if (this->addr != NULL) {
+    munmap(this->addr, this->len);
+  }
+  this->addr = NULL;
+  this->len = 0;
+  this->p = NULL;
+  this->end = NULL;
+}
+
+bool TextFileMap::Open(std::string fname) {
+  this->Close();
+  int fd = open(fname.c_str(), O_RDONLY);
+  if (fd < 0) {
+    std::cerr << "error opening file " << fname << std::endl;
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    std::cerr << "error reading file " << fname << std::endl;
+    close(fd);
+    return false;
+  }
+  if (st.st_size == 0) { // nothing to map, every read hits the end
+    close(fd);
+    return true;
+  }
+  this->len = st.st_size;
+  this->addr = mmap(NULL, this->len, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (this->addr == MAP_FAILED) {
+    std::cerr << "error mapping file " << fname << std::endl;
+    this->addr = NULL;
+    this->len = 0;
+    return false;
+  }
+  madvise(this->addr, this->len, MADV_SEQUENTIAL);
+  this->p = static_cast<const char *>(this->addr);
+  this->end = this->p + this->len;
+  return true;
+}
+
+// returns the next whitespace delimited token, false at end of file
+bool TextFileMap::NextToken(const char **tok, size_t *len) {
+  const char *q = this->p;
+  while ((q < this->end) && std::isspace(static_cast<unsigned char>(*q))) {
+    q++;
+  }
+  if (q == this->end) {
+    this->p = q;
+    return false;
+  }
+  *tok = q;
+  while ((q < this->end) && !std::isspace(static_cast<unsigned char>(*q))) {
+    q++;
+  }
+  *len = q - *tok;
+  this->p = q;
+  return true;
+}
+
+// returns the next token as a 32 bit unsigned, false if it is not one
+bool TextFileMap::NextUint(uint32_t *val) {
+  const char *tok;
+  size_t len;
+  if (!this->NextToken(&tok, &len)) {
+    return false;
+  }
+  uint64_t v = 0;
+  for (size_t ix = 0; ix < len; ix++) {
+    if (!std::isdigit(static_cast<unsigned char>(tok[ix]))) {
+      return false;
+    }
+    v = v * 10 + (tok[ix] - '0');
+    if (v > 0xFFFFFFFFULL) {
+      return false;
+    }
+  }
+  *val = v;
+  return true;
+}
+
+bool tokenIs(const char *tok, size_t len, const char *s) {
+  // gate names are matched ignoring case, as the analyzer always has
+  return (std::strlen(s) == len) && (strncasecmp(tok, s, len) == 0);
+}
+
+std::string cktFileName(std::string fname) {
+  // foo.out -> foo.ckt
+  auto dot = fname.rfind('.');
+  auto slash = fname.rfind('/');
+  if ((dot != std::string::npos) &&
+      ((slash == std::string::npos) || (dot > slash))) {
+    fname = fname.substr(0, dot);
+  }
+  return fname + ".ckt";
+}
+
+bool isCktFileCurrent(std::string cktFname, std::string srcFname) {
+  // true if the compiled file exists and is not older than its source
+  struct stat ckt_st, src_st;
+  if (stat(cktFname.c_str(), &ckt_st) != 0) {
+    return false;
+  }
+  if (stat(srcFname.c_str(), &src_st) != 0) {
+    return isCktFile(cktFname); // no source, use what we have
+  }
+  bool newer = (ckt_st.st_mtim.tv_sec > src_st.st_mtim.tv_sec) ||
+               ((ckt_st.st_mtim.tv_sec == src_st.st_mtim.tv_sec) &&
+                (ckt_st.st_mtim.tv_nsec >= src_st.st_mtim.tv_nsec));
+  return newer && isCktFile(cktFname);
+}
+
+bool isCktFile(std::string fname) {
+  // check for the magic number at the start of the file
+  char magic[sizeof(CKT_FILE_MAGIC)];
+  FILE *fid = fopen(fname.c_str(), "rb");
+  if (fid == NULL) {
+    return false;
+  }
+  bool ok = (fread(magic, sizeof(magic), 1, fid) == 1);
+  fclose(fid);
+  return ok && (std::memcmp(magic, CKT_FILE_MAGIC, sizeof(magic)) == 0);
+}
+
+uint64_t cktChecksum(const unsigned char *data, size_t len) {
+  // 64 bit FNV-1a
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (size_t ix = 0; ix < len; ix++) {
+    hash ^= data[ix];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
@@ -0,0 +1,168 @@
+// @file cktfile.h -- compiled binary circuit file format
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other
+// contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+#ifndef SRC_CKTFILE_H_
+#define SRC_CKTFILE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gate.h"
+
+// The compiled circuit file (*.ckt) is a binary image of an assembled
+// circuit that can be memory mapped and loaded by Circuit without
+// reparsing the text *.out assembler listing.
+//
+// Layout (all fields are native endian 32 bit unsigned unless noted):
+//   CktFileHeader
+//   in_bits[n_inputs]              number of bits of each input bus
+//   out_bits[n_outputs]            number of bits of each output bus
+//   CktFileGate input_gates[n_input_gates]
+//   CktFileGate gates[n_gates]     all other gates in program order
+//   fanout_start[n_wires + 1]      CSR row offsets into fanout_gates
+//   fanout_gates[n_fanout]         indices into gates fed by each wire
+//
+// The checksum is a 64 bit FNV-1a hash of everything after the header.
+// Bump CKT_FILE_VERSION whenever the layout or the gate opcodes change.
+
+const char CKT_FILE_MAGIC[8] = {'O', 'E', 'C', 'E', 'C', 'K', 'T', '\0'};
+const uint32_t CKT_FILE_VERSION = 1;
+const uint32_t CKT_FILE_MAX_IN = 4; // max inputs of any gate
+const uint32_t CKT_FILE_NONE = 0xFFFFFFFF; // unused wire or bus field
+
+struct CktFileHeader {
+  char magic[8];          // CKT_FILE_MAGIC
+  uint32_t version;       // CKT_FILE_VERSION
+  uint32_t n_inputs;      // number of input buses
+  uint32_t n_outputs;     // number of output buses
+  uint32_t n_input_gates; // number of INPUT gates
+  uint32_t n_gates;       // number of all other gates
+  uint32_t n_wires;       // number of wires (wire ids are 0..n_wires-1)
+  uint32_t n_fanout;      // total number of fanout entries
+  uint32_t reserved;      // zero
+  uint64_t checksum;      // FNV-1a of the rest of the file
+};
+
+struct CktFileGate {
+  uint32_t op;                  // GateEnum value
+  uint32_t n_in;                // number of valid entries in in[]
+  uint32_t in[CKT_FILE_MAX_IN]; // input wire ids
+  uint32_t out;                 // output wire id (OUTPUT gates: none)
+  uint32_t bus;                 // INPUT/OUTPUT gates: bus number
+                                // LUT3/LUT4 gates: truth table
+  uint32_t bit;                 // INPUT/OUTPUT gates: bit number
+};
+
+// read only view of a compiled circuit, either memory mapped from a
+// file by CktFileMap or pointing into a CktFile
+class CktView {
+public:
+  CktView();
+  uint32_t n_inputs;
+  uint32_t n_outputs;
+  uint32_t n_input_gates;
+  uint32_t n_gates;
+  uint32_t n_wires;
+  uint32_t n_fanout;
+  const uint32_t *in_bits;
+  const uint32_t *out_bits;
+  const CktFileGate *input_gates;
+  const CktFileGate *gates;
+  const uint32_t *fanout_start;
+  const uint32_t *fanout_gates;
+};
+
+// in memory form of a compiled circuit used for writing files
+class CktFile {
+public:
+  CktFile();
+  std::vector<uint32_t> in_bits;
+  std::vector<uint32_t> out_bits;
+  std::vector<CktFileGate> input_gates;
+  std::vector<CktFileGate> gates;
+  uint32_t n_wires;
+  std::vector<uint32_t> fanout_start;
+  std::vector<uint32_t> fanout_gates;
+
+  void AddInput(uint32_t bus, uint32_t bit, uint32_t wire);
+  void AddGate(GateEnum op, std::vector<uint32_t> in, uint32_t wire);
+  void AddOutput(uint32_t bus, uint32_t bit, uint32_t wire);
+  void AddLut(GateEnum op, std::vector<uint32_t> in, uint32_t table,
+              uint32_t wire);
+  void GenerateFanout(void);
+  CktView View(void);
+  bool Write(std::string fname);
+  bool ReadBristol(std::string fname, bool new_flag);
+};
+
+// read only memory mapping of a compiled circuit file
+class CktFileMap : public CktView {
+public:
+  CktFileMap();
+  ~CktFileMap();
+  bool Open(std::string fname);
+  void Close(void);
+
+private:
+  void *addr;
+  size_t len;
+};
+
+// read only memory mapping of a text circuit file (Bristol or .out)
+// with a whitespace tokenizer that walks the mapping in place
+class TextFileMap {
+public:
+  TextFileMap();
+  ~TextFileMap();
+  bool Open(std::string fname);
+  void Close(void);
+  bool NextToken(const char **tok, size_t *len);
+  bool NextUint(uint32_t *val);
+
+private:
+  void *addr;
+  size_t len;
+  const char *p;
+  const char *end;
+};
+
+// function declaration
+bool tokenIs(const char *tok, size_t len, const char *s);
+std::string cktFileName(std::string fname);
+bool isCktFile(std::string fname);
+bool isCktFileCurrent(std::string cktFname, std::string srcFname);
+uint64_t cktChecksum(const unsigned char *data, size_t len);
+
+#endif // SRC_CKTFILE_H_
@@ -0,0 +1,289 @@
+// @file client.cpp -- keys, encryption and decryption for a circuit user
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other
+// contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+#include "client.h"
+
+#include <sys/stat.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include "binfhecontext-ser.h"
+
+XorEnum DefaultXorMode(lbcrypto::BINFHE_PARAMSET set) {
+  // the native gate for TOY, STD128_OPT decomposes it
+  return (set == lbcrypto::TOY) ? XorEnum::NATIVE : XorEnum::DECOMPOSED;
+}
+
+CircuitClient::CircuitClient(lbcrypto::BINFHE_PARAMSET set,
+                             lbcrypto::BINFHE_METHOD method,
+                             std::string keyStore, Encoding encoding)
+    : CircuitClient(set, method, DefaultXorMode(set), keyStore, encoding) {}
+
+CircuitClient::CircuitClient(lbcrypto::BINFHE_PARAMSET set,
+                             lbcrypto::BINFHE_METHOD method,
+                             XorEnum xor_mode, std::string keyStore,
+                             Encoding encoding)
+    : xor_mode(xor_mode), set(set), method(method), encoding(encoding),
+      keyStore(keyStore) {
+  std::string set_name;
+  std::string method_name;
+  if (set == lbcrypto::TOY) {
+    set_name = "TOY";
+    std::cout << "*************************" << std::endl;
+    std::cout << "WARNING TOY Security used" << std::endl;
+    std::cout << "*************************" << std::endl;
+  } else if (set == lbcrypto::STD128_OPT) {
+    set_name = "STD128_OPT";
+    std::cout << "STD 128 Optimized Security used" << std::endl;
+  } else {
+    std::cerr << "Error Bad security" << std::endl;
+    exit(-1);
+  }
+  if (method == lbcrypto::AP) {
+    method_name = "AP";
+    std::cout << "AP used" << std::endl;
+  } else if (method == lbcrypto::GINX) {
+    method_name = "GINX";
+    std::cout << "GINX used" << std::endl;
+  } else {
+    std::cerr << "Error Bad method" << std::endl;
+    exit(-1);
+  }
+  if (encoding.kind == EncodingEnum::MULTI_INPUT) {
+    // the native XOR gates only take a plaintext modulus of 4
+    this->xor_mode = XorEnum::DECOMPOSED;
+  }
+  std::cout << XorModeName(this->xor_mode) << " xor used" << std::endl;
+  std::string encoding_name;
+  if (encoding.kind != EncodingEnum::BOOLEAN) {
+    encoding_name = EncodingName(encoding) + "_";
+    std::cout << EncodingName(encoding) << " encoding used" << std::endl;
+  }
+
+  // key files are <keyStore>/<set>_<method>_[<encoding>_]<key>.bin
+  std::string prefix;
+  if (!keyStore.empty()) {
+    prefix = keyStore + "/" + set_name + "_" + method_name + "_" +
+             encoding_name;
+    if (this->_LoadKeys(prefix)) {
+      std::cout << "Loaded crypto keys from " << prefix << "*.bin"
+                << std::endl;
+      return;
+    }
+  }
+
+  std::cout << "Generating crypto context" << std::endl;
+  this->_GenerateContext();
+  std::cout << "Generating crypto keys" << std::endl;
+  this->sk = cc.KeyGen();
+  this->cc.BTKeyGen(this->sk);
+  std::cout << "Done" << std::endl;
+
+  if (!keyStore.empty()) {
+    mkdir(keyStore.c_str(), 0700); // may already exist, holds the sk
+    if (this->_SaveKeys(prefix)) {
+      std::cout << "Saved crypto keys to " << prefix << "*.bin" << std::endl;
+    } else {
+      std::cerr << "Warning could not save crypto keys to " << prefix
+                << "*.bin" << std::endl;
+    }
+  }
+}
+
+void CircuitClient::_GenerateContext(void) {
+  // a context for the encoding of the keys. Functional bootstrapping has
+  // its own parameters, with a plaintext space that grows with the
+  // modulus, so logQ is raised until the space holds the encoding
+  this->cc = lbcrypto::BinFHEContext();
+  if (this->encoding.kind == EncodingEnum::BOOLEAN) {
+    this->cc.GenerateBinFHEContext(this->set, this->method);
+    return;
+  }
+  if (this->encoding.kind == EncodingEnum::MULTI_INPUT) {
+    // multi-input gates have their own parameter sets, TOY has none
+    bool three = (this->encoding.fan_in == 3);
+    lbcrypto::BINFHE_PARAMSET set;
+    if (this->set == lbcrypto::STD128_OPT) {
+      set = three ? lbcrypto::STD128_3_OPT : lbcrypto::STD128_4_OPT;
+      std::cout << (three ? "STD128_3_OPT" : "STD128_4_OPT");
+    } else {
+      set = three ? lbcrypto::STD128_3 : lbcrypto::STD128_4;
+      std::cout << (three ? "STD128_3" : "STD128_4");
+    }
+    std::cout << " used for the multi-input gates" << std::endl;
+    this->cc.GenerateBinFHEContext(set, this->method);
+    return;
+  }
+  if (this->method != lbcrypto::GINX) {
+    std::cerr << "Error the " << EncodingName(this->encoding)
+              << " encoding needs GINX" << std::endl;
+    exit(-1);
+  }
+  auto set = (this->set == lbcrypto::STD128_OPT) ? lbcrypto::STD128 : this->set;
+  auto p = PlaintextModulus(this->encoding);
+  for (uint32_t logQ = 11; logQ <= 20; logQ++) {
+    this->cc = lbcrypto::BinFHEContext();
+    this->cc.GenerateBinFHEContext(set, true, logQ, 0, this->method);
+    if (this->cc.GetMaxPlaintextSpace().ConvertToInt() >= p) {
+      std::cout << "logQ " << logQ << " used" << std::endl;
+      return;
+    }
+  }
+  std::cerr << "Error no functional context holds a plaintext modulus of "
+            << p << std::endl;
+  exit(-1);
+}
+
+bool CircuitClient::_LoadKeys(std::string prefix) {
+  // load the context, the bootstrapping keys and the secret key, false if
+  // any of them is missing
+  lbcrypto::BinFHEContext loaded;
+  lbcrypto::RingGSWACCKey refreshKey;
+  lbcrypto::LWESwitchingKey switchKey;
+  lbcrypto::LWEPrivateKey loaded_sk;
+  if (!lbcrypto::Serial::DeserializeFromFile(prefix + "context.bin", loaded,
+                                             lbcrypto::SerType::BINARY) ||
+      !lbcrypto::Serial::DeserializeFromFile(prefix + "refresh.bin",
+                                             refreshKey,
+                                             lbcrypto::SerType::BINARY) ||
+      !lbcrypto::Serial::DeserializeFromFile(prefix + "switch.bin", switchKey,
+                                             lbcrypto::SerType::BINARY) ||
+      !lbcrypto::Serial::DeserializeFromFile(prefix + "sk.bin", loaded_sk,
+                                             lbcrypto::SerType::BINARY)) {
+    return false;
+  }
+  loaded.BTKeyLoad({refreshKey, switchKey});
+  this->cc = loaded;
+  this->sk = loaded_sk;
+  return true;
+}
+
+// write one key file under a temporary name and rename it into place, so
+// a concurrent run never loads a partly written key
+template <typename T>
+static bool save_key(std::string fname, const T &key) {
+  std::string tmpname = fname + ".tmp";
+  if (!lbcrypto::Serial::SerializeToFile(tmpname, key,
+                                         lbcrypto::SerType::BINARY)) {
+    std::remove(tmpname.c_str());
+    return false;
+  }
+  return std::rename(tmpname.c_str(), fname.c_str()) == 0;
+}
+
+bool CircuitClient::_SaveKeys(std::string prefix) {
+  // the context is written last, so its presence marks a complete set
+  return save_key(prefix + "sk.bin", this->sk) &&
+         save_key(prefix + "refresh.bin", this->cc.GetRefreshKey()) &&
+         save_key(prefix + "switch.bin", this->cc.GetSwitchKey()) &&
+         save_key(prefix + "context.bin", this->cc);
+}
+
+CircuitClient::~CircuitClient(void) {}
+
+EncInputs CircuitClient::Encrypt(const Inputs &input) const {
+  // encrypt every bit of every input bus
+  EncInputs encin(input.size());
+  for (unsigned int ix = 0; ix < input.size(); ix++) {
+    encin[ix].resize(input[ix].size());
+    for (unsigned int bit = 0; bit < input[ix].size(); bit++) {
+      encin[ix][bit] =
+          this->cc.Encrypt(this->sk, input[ix][bit], lbcrypto::BOOTSTRAPPED,
+                           PlaintextModulus(this->encoding));
+    }
+  }
+  return encin;
+}
+
+Outputs CircuitClient::Decrypt(const EncOutputs &output) const {
+  // decrypt every bit of every output bus. A missing ciphertext (from a
+  // gate the evaluator could not compute) decrypts to 0
+  Outputs out(output.size());
+  for (unsigned int ix = 0; ix < output.size(); ix++) {
+    out[ix].assign(output[ix].size(), 0);
+    for (unsigned int bit = 0; bit < output[ix].size(); bit++) {
+      if (output[ix][bit]) {
+        lbcrypto::LWEPlaintext res;
+        this->cc.Decrypt(this->sk, output[ix][bit], &res,
+                         PlaintextModulus(this->encoding));
+        out[ix][bit] = res;
+      }
+    }
+  }
+  return out;
+}
+
+lbcrypto::BinFHEContext CircuitClient::getContext(void) const {
+  return this->cc;
+}
+
+lbcrypto::LWEPrivateKey CircuitClient::getSecretKey(void) const {
+  return this->sk;
+}
+
+XorEnum CircuitClient::getXorMode(void) const { return this->xor_mode; }
+
+lbcrypto::BINFHE_PARAMSET CircuitClient::getParamSet(void) const {
+  return this->set;
+}
+
+lbcrypto::BINFHE_METHOD CircuitClient::getMethod(void) const {
+  return this->method;
+}
+
+Encoding CircuitClient::getEncoding(void) const { return this->encoding; }
+
+std::string CircuitClient::getKeyStore(void) const { return this->keyStore; }
+
+std::shared_ptr<const CircuitClient>
+KeysForEncoding(std::shared_ptr<const CircuitClient> keys,
+                const Encoding &encoding) {
+  // keys with the parameter set of keys made for encoding, keys itself if
+  // it already is. Functional bootstrapping only has a GINX method
+  if (keys->getEncoding() == encoding) {
+    return keys;
+  }
+  std::cout << "Separate keys for the " << EncodingName(encoding)
+            << " encoding, the " << EncodingName(keys->getEncoding())
+            << " ciphertexts can not be used with them" << std::endl;
+  auto method = (encoding.kind == EncodingEnum::FUNCTIONAL)
+                    ? lbcrypto::GINX
+                    : keys->getMethod();
+  return std::make_shared<const CircuitClient>(
+      keys->getParamSet(), method, keys->getXorMode(), keys->getKeyStore(),
+      encoding);
+}
@@ -0,0 +1,113 @@
+// @file client.h -- keys, encryption and decryption for a circuit user
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other
+// contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+#ifndef SRC_CLIENT_H_
+#define SRC_CLIENT_H_
+
+#include <memory>
+#include <string>
+
+#include "binfhecontext.h"
+
+#include "compiled.h"
+#include "gate.h"
+
+// The client side of an encrypted evaluation. It generates the keys,
+// encrypts the inputs and decrypts the outputs. The evaluator only needs
+// the context returned by getContext(), which holds the bootstrapping
+// keys but not the secret key.
+//
+// Key generation takes seconds to minutes for STD128_OPT, so the context
+// and keys can be kept in a key store directory. A client whose key store
+// holds keys for its parameter set and method loads them from there,
+// otherwise it generates them and saves them for the next run. With no
+// key store (the default) the keys are always generated.
+//
+// The client also picks how the evaluator computes XOR (see XorEnum).
+// Unless one is given, DefaultXorMode() picks it for the parameter set:
+// NATIVE for TOY and DECOMPOSED for STD128_OPT, where the native gate
+// fails more often.
+//
+// The keys are made for one Encoding of the bits, and an encrypted run
+// of a circuit that needs another one (see RequiredEncoding()) stops with
+// an error. The key store holds one set of keys per encoding, so clients
+// for several encodings can share it. Their ciphertexts do not mix: the
+// inputs of a circuit must be encrypted by a client for its encoding. A
+// MULTI_INPUT client uses the STD128_3 or STD128_4 parameter sets (the
+// _OPT ones for STD128_OPT) and DECOMPOSED XOR. A FUNCTIONAL client makes
+// a context for arbitrary functions, which needs GINX and uses STD128 in
+// place of STD128_OPT.
+class CircuitClient {
+public:
+  CircuitClient(lbcrypto::BINFHE_PARAMSET set, lbcrypto::BINFHE_METHOD method,
+                std::string keyStore = "", Encoding encoding = Encoding());
+  CircuitClient(lbcrypto::BINFHE_PARAMSET set, lbcrypto::BINFHE_METHOD method,
+                XorEnum xor_mode, std::string keyStore = "",
+                Encoding encoding = Encoding());
+  ~CircuitClient();
+  EncInputs Encrypt(const Inputs &input) const;
+  Outputs Decrypt(const EncOutputs &output) const;
+  lbcrypto::BinFHEContext getContext(void) const;
+  lbcrypto::LWEPrivateKey getSecretKey(void) const;
+  XorEnum getXorMode(void) const;
+  lbcrypto::BINFHE_PARAMSET getParamSet(void) const;
+  lbcrypto::BINFHE_METHOD getMethod(void) const;
+  Encoding getEncoding(void) const;
+  std::string getKeyStore(void) const;
+
+private:
+  lbcrypto::BinFHEContext cc;
+  lbcrypto::LWEPrivateKey sk;
+  XorEnum xor_mode;
+  lbcrypto::BINFHE_PARAMSET set;
+  lbcrypto::BINFHE_METHOD method;
+  Encoding encoding;
+  std::string keyStore;
+
+  void _GenerateContext(void);
+  bool _LoadKeys(std::string prefix);
+  bool _SaveKeys(std::string prefix);
+};
+
+// function declaration
+XorEnum DefaultXorMode(lbcrypto::BINFHE_PARAMSET set);
+// keys itself if they are made for encoding, otherwise a second client
+// with the same settings for encoding. That client has its own keys,
+// loaded from the key store of keys or generated, and says so
+std::shared_ptr<const CircuitClient>
+KeysForEncoding(std::shared_ptr<const CircuitClient> keys,
+                const Encoding &encoding);
+
+#endif // SRC_CLIENT_H_
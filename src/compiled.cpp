@@ -0,0 +1,873 @@
+// @file compiled.cpp -- a loaded circuit shared by its evaluations
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other
+// contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+#include "compiled.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#include "utils.h"
+
+CompiledCircuit::CompiledCircuit(void) {
+  this->n_wires = 0;
+  this->n_outputs = 0;
+  this->n_clocked_gates = 0;
+  this->gatePriority.assign(N_XOR_MODES, GateIndexList());
+}
+
+// parse a register token, either R<reg> or the SSA form R<reg>.<version>
+// written by the assembler, into its wire name and register number
+static bool parse_reg(const char *tok, std::string *wireName,
+                      unsigned int *reg) {
+  const char *p = tok;
+  if (*p++ != 'R' || !std::isdigit(static_cast<unsigned char>(*p))) {
+    return false;
+  }
+  char *end;
+  *reg = std::strtoul(p, &end, 10);
+  p = end;
+  if (*p == '.') {
+    p++;
+    if (!std::isdigit(static_cast<unsigned char>(*p))) {
+      return false;
+    }
+    std::strtoul(p, &end, 10);
+    p = end;
+  }
+  if (*p != '\0') {
+    return false;
+  }
+  *wireName = "R:" + std::string(tok + 1);
+  return true;
+}
+
+// the gates with three or four inputs, written NAME(in0, in1, in2[, in3])
+static bool multi_input_op(std::string tline, GateEnum *op) {
+  for (auto m : {GateEnum::AND3, GateEnum::OR3, GateEnum::AND4, GateEnum::OR4,
+                 GateEnum::MAJORITY, GateEnum::CMUX}) {
+    if (contains(tline, " " + GateOpName(m) + "(")) {
+      *op = m;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool CompiledCircuit::ReadFile(std::string inFname) {
+  // parse the input file and generate the
+  // various lists to define the circuit.
+
+  // std::vector <unsigned int> out(n_out_bits, 0);
+  // //Plaintext out
+  // std::vector <unsigned int> pout(n_out_bits, 0);
+  // use the compiled form of the circuit if it exists and is up to date
+  if (isCktFile(inFname)) {
+    return this->_ReadCktFile(inFname);
+  }
+  std::string cktFname = cktFileName(inFname);
+  if (isCktFileCurrent(cktFname, inFname) && this->_ReadCktFile(cktFname)) {
+    return true;
+  }
+
+  std::cout << "Loading circuit description " << inFname << std::endl;
+  TIC(auto t_load);
+  this->inputGates.clear();
+  this->allGates.clear();
+  unsigned int load_time = 0;
+  unsigned int parse_time = 0;
+  unsigned int netlist_time = 0;
+
+  // open the program file to determine some parameters for tests
+  std::ifstream inFile;
+  // Set exceptions to be thrown on failure
+  inFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+
+  try {
+    inFile.open(inFname.c_str());
+  } catch (std::system_error &e) {
+    std::cerr << e.code().message() << std::endl;
+    std::cerr << "error opening file.. exiting!" << std::endl;
+    exit(-1);
+  }
+
+  unsigned int lineNo = 0;
+  unsigned int gateNo = 0;
+
+  unsigned int max_output_bits(0);
+  unsigned int max_reg(0);
+  std::string tline;
+  try {
+    while (std::getline(inFile, tline)) {
+      lineNo++;
+      if (lineNo % 100 == 0) {
+        std::cout << "\r loading line " << lineNo << std::flush;
+      }
+      if (tline[0] == '#') {
+        continue; // ignore comment lines
+      }
+      Gate g;
+
+      unsigned int n1, n2, n3;
+      unsigned int n;
+      char r1[32], r2[32], r3[32];
+      std::string in1, in2, out1;
+      if (contains(tline, "LOAD")) {
+        n = sscanf(tline.c_str(), "%31[R0-9.] = LOAD(In%d, %d)", r1, &n2, &n3);
+        if ((n != 3) || !parse_reg(r1, &out1, &n1)) {
+          std::cerr << "LOAD parse error line " << lineNo << std::endl;
+          exit(-1);
+        }
+
+        // create INPUT gate
+        // load input n2, bit n3 to register n1
+        // reg[n1] = in[n2-1][n3];
+        g.id = gateNo;
+        g.op = GateEnum::INPUT;
+        g.bus = n2 - 1;
+        g.bit = n3;
+        max_reg = std::max(max_reg, n1);
+        g.outWireNames.push_back(out1);
+
+        gateNo++;
+        this->inputGates.push_back(g);
+
+      } else if (contains(tline, "STORE")) {
+        n = sscanf(tline.c_str(), "Out%d = STORE(%31[R0-9.])", &n1, r2);
+        if ((n != 2) || !parse_reg(r2, &in1, &n2)) {
+          std::cerr << "STORE parse error line " << lineNo << std::endl;
+          exit(-1);
+        }
+        // store register n2 into out n1
+        // out[n1] = reg[n2];
+        g.id = gateNo;
+        g.op = GateEnum::OUTPUT;
+        // right now there is only one output allowed
+        g.bus = 0;
+        g.bit = n1;
+        g.inWireNames.push_back(in1);
+
+        gateNo++;
+        this->allGates.push_back(g);
+
+        // update the output bit size
+        max_output_bits = std::max(max_output_bits, n1);
+
+      } else if (multi_input_op(tline, &g.op)) {
+        char r4[32], r5[32];
+        unsigned int n_in = GateInputCount(g.op);
+        std::string format = "%31[R0-9.] = " + GateOpName(g.op) +
+                             "(%31[R0-9.], %31[R0-9.], %31[R0-9.]" +
+                             ((n_in == 4) ? ", %31[R0-9.])" : ")");
+        n = sscanf(tline.c_str(), format.c_str(), r1, r2, r3, r4, r5);
+        if ((n != n_in + 1) || !parse_reg(r1, &out1, &n1)) {
+          std::cerr << GateOpName(g.op) << " parse error line " << lineNo
+                    << std::endl;
+          exit(-1);
+        }
+        // register n1 = op of registers in0 .. in3
+        // reg[n1] = reg[in0] & reg[in1] & reg[in2] (& reg[in3]);
+        // reg[n1] = majority(reg[in0], reg[in1], reg[in2]);
+        // reg[n1] = reg[in2] ? reg[in1] : reg[in0];
+        g.id = gateNo;
+        max_reg = std::max(max_reg, n1);
+        for (auto r : {r2, r3, r4, r5}) {
+          if (g.inWireNames.size() == n_in) {
+            break;
+          }
+          if (!parse_reg(r, &in1, &n2)) {
+            std::cerr << GateOpName(g.op) << " parse error line " << lineNo
+                      << std::endl;
+            exit(-1);
+          }
+          g.inWireNames.push_back(in1);
+        }
+        g.outWireNames.push_back(out1);
+        gateNo++;
+        this->allGates.push_back(g);
+
+      } else if (contains(tline, "NOT")) {
+        n = sscanf(tline.c_str(), "%31[R0-9.] = NOT(%31[R0-9.])", r1, r2);
+        if ((n != 2) || !parse_reg(r1, &out1, &n1) ||
+            !parse_reg(r2, &in1, &n2)) {
+          std::cerr << "NOT parse error line " << lineNo << std::endl;
+          exit(-1);
+        }
+
+        //  register n1 = not(register n2)
+        // store register n2 into out n1
+        // out[n1] = reg[n2];
+        g.id = gateNo;
+        g.op = GateEnum::NOT;
+        max_reg = std::max(max_reg, n1);
+        g.inWireNames.push_back(in1);
+        g.outWireNames.push_back(out1);
+
+        gateNo++;
+        this->allGates.push_back(g);
+
+      } else if (contains(tline, "AND")) {
+        n = sscanf(tline.c_str(),
+                   "%31[R0-9.] = AND(%31[R0-9.], %31[R0-9.])", r1, r2, r3);
+        if ((n != 3) || !parse_reg(r1, &out1, &n1) ||
+            !parse_reg(r2, &in1, &n2) || !parse_reg(r3, &in2, &n3)) {
+          std::cerr << "AND parse error line " << lineNo << std::endl;
+          exit(-1);
+        }
+
+        //  register n1 = and(n2, n3)
+        // reg[n1] = and(reg[n2], reg[n3]);
+        g.id = gateNo;
+        g.op = GateEnum::AND;
+        max_reg = std::max(max_reg, n1);
+        g.inWireNames.push_back(in1);
+        g.inWireNames.push_back(in2);
+        g.outWireNames.push_back(out1);
+        gateNo++;
+        this->allGates.push_back(g);
+
+      } else if (contains(tline, " OR")) {
+        n = sscanf(tline.c_str(),
+                   "%31[R0-9.] = OR(%31[R0-9.], %31[R0-9.])", r1, r2, r3);
+        if ((n != 3) || !parse_reg(r1, &out1, &n1) ||
+            !parse_reg(r2, &in1, &n2) || !parse_reg(r3, &in2, &n3)) {
+          std::cerr << "OR parse error line " << lineNo << std::endl;
+          exit(-1);
+        }
+
+        //  register n1 = or(n2, n3)
+        // reg[n1] = or(reg[n2], reg[n3]);
+        // reg[n1] = reg[n2] or reg[n3];
+        g.id = gateNo;
+        g.op = GateEnum::OR;
+        max_reg = std::max(max_reg, n1);
+        g.inWireNames.push_back(in1);
+        g.inWireNames.push_back(in2);
+        g.outWireNames.push_back(out1);
+        gateNo++;
+        this->allGates.push_back(g);
+
+      } else if (contains(tline, "XOR")) {
+        n = sscanf(tline.c_str(),
+                   "%31[R0-9.] = XOR(%31[R0-9.], %31[R0-9.])", r1, r2, r3);
+        if ((n != 3) || !parse_reg(r1, &out1, &n1) ||
+            !parse_reg(r2, &in1, &n2) || !parse_reg(r3, &in2, &n3)) {
+          std::cerr << "XOR parse error line " << lineNo << std::endl;
+          exit(-1);
+        }
+        //  register n1 = xor(n2, n3)
+        // reg[n1] = xor(reg[n2], reg[n3]);
+        g.id = gateNo;
+        g.op = GateEnum::XOR;
+        max_reg = std::max(max_reg, n1);
+        g.inWireNames.push_back(in1);
+        g.inWireNames.push_back(in2);
+        g.outWireNames.push_back(out1);
+        gateNo++;
+        this->allGates.push_back(g);
+
+      } else if (contains(tline, "LUT")) {
+        unsigned int table;
+        char r4[32], r5[32];
+        g.op = contains(tline, "LUT4") ? GateEnum::LUT4 : GateEnum::LUT3;
+        unsigned int n_in = (g.op == GateEnum::LUT4) ? 4 : 3;
+        if (n_in == 4) {
+          n = sscanf(tline.c_str(),
+                     "%31[R0-9.] = LUT4(%31[R0-9.], %31[R0-9.], %31[R0-9.], "
+                     "%31[R0-9.], %x)",
+                     r1, r2, r3, r4, r5, &table);
+        } else {
+          n = sscanf(tline.c_str(),
+                     "%31[R0-9.] = LUT3(%31[R0-9.], %31[R0-9.], %31[R0-9.], "
+                     "%x)",
+                     r1, r2, r3, r4, &table);
+        }
+        if ((n != n_in + 2) || !parse_reg(r1, &out1, &n1)) {
+          std::cerr << "LUT parse error line " << lineNo << std::endl;
+          exit(-1);
+        }
+        // register n1 = bit in0 + 2 in1 + 4 in2 (+ 8 in3) of the table
+        // reg[n1] = table[reg[in0], reg[in1], ...];
+        g.id = gateNo;
+        g.table = table;
+        max_reg = std::max(max_reg, n1);
+        for (auto r : {r2, r3, r4, r5}) {
+          if (g.inWireNames.size() == n_in) {
+            break;
+          }
+          if (!parse_reg(r, &in1, &n2)) {
+            std::cerr << "LUT parse error line " << lineNo << std::endl;
+            exit(-1);
+          }
+          g.inWireNames.push_back(in1);
+        }
+        g.outWireNames.push_back(out1);
+        gateNo++;
+        this->allGates.push_back(g);
+
+      } else if (contains(tline, "DFF")) {
+        n = sscanf(tline.c_str(), "%31[R0-9.] = DFF(%31[R0-9.])", r1, r2);
+        if ((n != 2) || !parse_reg(r1, &out1, &n1) ||
+            !parse_reg(r2, &in1, &n2)) {
+          std::cerr << "DFF parse error line " << lineNo << std::endl;
+          exit(-1);
+        }
+
+        //  register n1 = register n2 of the last cycle
+        // reg[n1] <= reg[n2];
+        g.id = gateNo;
+        g.op = GateEnum::DFF;
+        max_reg = std::max(max_reg, n1);
+        g.inWireNames.push_back(in1);
+        g.outWireNames.push_back(out1);
+        gateNo++;
+        this->allGates.push_back(g);
+
+      } else if (contains(tline, "BOOT")) {
+        // No op
+      }
+
+    } // while
+  } catch (std::system_error &e) {
+    // std::cout<<"end of file"<<std::endl;
+    // end of file here.
+  }
+  try {
+    inFile.close();
+  } catch (std::system_error &e) {
+    std::cerr << e.code().message() << std::endl;
+    exit(-1);
+  }
+
+  // save output space
+  // for now fixed to single output bus.
+  max_output_bits++; // count was from 0
+  std::cout << std::endl
+            << "generating output nbits " << max_output_bits << std::endl;
+
+  this->n_outputs = 1; // fixed for now
+  this->n_output_bits.resize(1);
+  this->n_output_bits[0] = max_output_bits;
+
+  parse_time = TOC_MS(t_load);
+
+  // generate netlist
+  // number every register wire and build the integer fanout table
+  // used by the circuit manager in a single pass over the gates
+  std::cout << "generating netlist" << std::endl;
+  TIC(auto t_netlist);
+  this->wireIds.clear();
+  for (auto &g : this->inputGates) {
+    g.inWires.clear(); // input gates read from the Inputs, not from wires
+    g.outWires.clear();
+    for (auto ow : g.outWireNames) {
+      g.outWires.push_back(this->_getWireId(ow));
+    }
+  }
+  for (auto &g : this->allGates) {
+    g.inWires.clear();
+    g.outWires.clear();
+    for (auto iw : g.inWireNames) {
+      g.inWires.push_back(this->_getWireId(iw));
+    }
+    if (g.op != GateEnum::OUTPUT) { // output gates write to Outputs
+      for (auto ow : g.outWireNames) {
+        g.outWires.push_back(this->_getWireId(ow));
+      }
+    }
+  }
+  this->n_wires = this->wireIds.size();
+  // registers the listing reuses for its wires, only reported
+  unsigned int n_registers = std::min(max_reg + 1, this->n_wires);
+  this->_GenerateFanout();
+  this->_FindClocked();
+  this->_Levelize();
+  this->_Prioritize();
+  netlist_time = TOC_MS(t_netlist);
+  load_time = TOC_MS(t_load);
+  std::cout << "Done" << std::endl;
+  std::cout << "### Load time " << load_time << " msec (parse " << parse_time
+            << " msec, netlist " << netlist_time << " msec, "
+            << this->n_wires << " wires in " << n_registers
+            << " registers)" << std::endl;
+  return true;
+}
+
+unsigned int CompiledCircuit::_getWireId(std::string wireName) {
+  // return the id of the named wire, assigning the next free id if this
+  // is the first time it has been seen
+  auto it = this->wireIds.find(wireName);
+  if (it != this->wireIds.end()) {
+    return it->second;
+  }
+  unsigned int id = this->wireIds.size();
+  this->wireIds.insert({wireName, id});
+  return id;
+}
+
+void CompiledCircuit::_GenerateFanout(void) {
+  // build the CSR fanout table from the gate input wires with a counting
+  // pass followed by a fill pass, listing each gate once per wire.
+  this->fanoutStart.assign(this->n_wires + 1, 0);
+  for (auto const &g : this->allGates) {
+    for (uint ix = 0; ix < g.inWires.size(); ix++) {
+      if (std::find(g.inWires.begin(), g.inWires.begin() + ix,
+                    g.inWires[ix]) == g.inWires.begin() + ix) {
+        this->fanoutStart[g.inWires[ix] + 1]++;
+      }
+    }
+  }
+  for (uint wid = 0; wid < this->n_wires; wid++) {
+    this->fanoutStart[wid + 1] += this->fanoutStart[wid];
+  }
+  this->fanoutGates.assign(this->fanoutStart[this->n_wires], 0);
+  GateIndexList next(this->fanoutStart.begin(), this->fanoutStart.end() - 1);
+  for (unsigned int gix = 0; gix < this->allGates.size(); gix++) {
+    auto const &g = this->allGates[gix];
+    for (uint ix = 0; ix < g.inWires.size(); ix++) {
+      if (std::find(g.inWires.begin(), g.inWires.begin() + ix,
+                    g.inWires[ix]) == g.inWires.begin() + ix) {
+        this->fanoutGates[next[g.inWires[ix]]++] = gix;
+      }
+    }
+  }
+}
+
+void CompiledCircuit::_FindClocked(void) {
+  // list the DFFs and mark every gate reachable from a DFF output wire
+  // through the fanout table as clocked. A DFF stops the walk, its output
+  // is driven from the last cycle and is already a source
+  this->dffGates.clear();
+  this->dffIndex.clear();
+  this->gateClocked.assign(this->allGates.size(), false);
+  this->wireHeld.assign(this->n_wires, false);
+  this->heldWires.clear();
+  this->n_clocked_gates = 0;
+  GateIndexList clockedWires;
+  for (unsigned int gix = 0; gix < this->allGates.size(); gix++) {
+    auto const &g = this->allGates[gix];
+    if (g.op == GateEnum::DFF) {
+      this->dffIndex[gix] = this->dffGates.size();
+      this->dffGates.push_back(gix);
+      clockedWires.push_back(g.outWires[0]);
+    }
+  }
+  for (unsigned int cix = 0; cix < clockedWires.size(); cix++) {
+    auto wid = clockedWires[cix];
+    for (auto fix = fanoutStart[wid]; fix < fanoutStart[wid + 1]; fix++) {
+      auto gix = fanoutGates[fix];
+      if (this->gateClocked[gix]) {
+        continue;
+      }
+      this->gateClocked[gix] = true;
+      this->n_clocked_gates++;
+      auto const &g = this->allGates[gix];
+      if (g.op != GateEnum::DFF) {
+        for (auto ow : g.outWires) {
+          clockedWires.push_back(ow);
+        }
+      }
+    }
+  }
+
+  // the unclocked wires read by clocked gates are held between cycles
+  std::vector<bool> wireClocked(this->n_wires, false);
+  for (auto wid : clockedWires) {
+    wireClocked[wid] = true;
+  }
+  for (unsigned int gix = 0; gix < this->allGates.size(); gix++) {
+    if (!this->gateClocked[gix]) {
+      continue;
+    }
+    for (auto iw : this->allGates[gix].inWires) {
+      if (!wireClocked[iw] && !this->wireHeld[iw]) {
+        this->wireHeld[iw] = true;
+        this->heldWires.push_back(iw);
+      }
+    }
+  }
+  if (!this->dffGates.empty()) {
+    std::cout << "circuit has " << this->dffGates.size() << " DFFs, "
+              << this->n_clocked_gates << " clocked gates and "
+              << this->heldWires.size() << " held wires" << std::endl;
+  }
+}
+
+void CompiledCircuit::_Levelize(void) {
+  // compute the level of every gate with a breadth first walk of the
+  // fanout table from the wires driven by the input gates and the DFFs,
+  // and list the gates grouped by level for the LEVEL schedule
+  GateIndexList gateLevel(this->allGates.size(), 0);
+  GateIndexList gatePending(this->allGates.size(), 0);
+  GateIndexList wireLevel(this->n_wires, 0);
+  GateIndexList readyWires;
+  for (unsigned int gix = 0; gix < this->allGates.size(); gix++) {
+    gatePending[gix] = this->allGates[gix].inWires.size();
+  }
+  for (auto const &g : this->inputGates) {
+    for (auto wid : g.outWires) {
+      readyWires.push_back(wid);
+    }
+  }
+  for (auto gix : this->dffGates) {
+    readyWires.push_back(this->allGates[gix].outWires[0]);
+  }
+
+  unsigned int n_levels = 0;
+  unsigned int n_leveled = 0;
+  for (unsigned int rix = 0; rix < readyWires.size(); rix++) {
+    auto wid = readyWires[rix];
+    for (auto fix = fanoutStart[wid]; fix < fanoutStart[wid + 1]; fix++) {
+      auto gix = fanoutGates[fix];
+      auto const &g = this->allGates[gix];
+      for (auto iw : g.inWires) {
+        if (iw == wid) {
+          gatePending[gix]--;
+        }
+      }
+      gateLevel[gix] = std::max(gateLevel[gix], wireLevel[wid]);
+      if (gatePending[gix] == 0) {
+        n_leveled++;
+        n_levels = std::max(n_levels, gateLevel[gix] + 1);
+        if (g.op == GateEnum::DFF) {
+          continue; // its output is a source, driven from the last cycle
+        }
+        for (auto ow : g.outWires) {
+          wireLevel[ow] = gateLevel[gix] + 1;
+          readyWires.push_back(ow);
+        }
+      }
+    }
+  }
+  if (n_leveled != this->allGates.size()) {
+    std::cerr << "warning: " << this->allGates.size() - n_leveled
+              << " gates are not driven from the inputs" << std::endl;
+  }
+
+  // counting sort of the driven gates by level
+  this->levelStart.assign(n_levels + 1, 0);
+  for (unsigned int gix = 0; gix < this->allGates.size(); gix++) {
+    if (gatePending[gix] == 0) {
+      this->levelStart[gateLevel[gix] + 1]++;
+    }
+  }
+  for (unsigned int lix = 0; lix < n_levels; lix++) {
+    this->levelStart[lix + 1] += this->levelStart[lix];
+  }
+  this->levelGates.assign(n_leveled, 0);
+  GateIndexList next(this->levelStart.begin(), this->levelStart.end() - 1);
+  for (unsigned int gix = 0; gix < this->allGates.size(); gix++) {
+    if (gatePending[gix] == 0) {
+      this->levelGates[next[gateLevel[gix]]++] = gix;
+    }
+  }
+  std::cout << "circuit has " << n_levels << " levels" << std::endl;
+}
+
+void CompiledCircuit::_Prioritize(void) {
+  // walk the levels from the outputs back to the inputs so that every
+  // fanout gate is done before the gates driving it, and give each gate
+  // its own bootstrap cost plus the highest priority in its fanout. This
+  // is done for each XOR mode, an evaluation uses the table of its own
+  this->gatePriority.assign(N_XOR_MODES, GateIndexList());
+  std::cout << "critical path is";
+  for (unsigned int mode = 0; mode < N_XOR_MODES; mode++) {
+    auto xor_mode = static_cast<XorEnum>(mode);
+    auto &priority = this->gatePriority[mode];
+    priority.assign(this->allGates.size(), 0);
+    unsigned int critical_path = 0;
+    for (auto it = this->levelGates.rbegin(); it != this->levelGates.rend();
+         it++) {
+      auto const &g = this->allGates[*it];
+      unsigned int fanout_priority = 0;
+      for (auto wid : g.outWires) {
+        if (g.op == GateEnum::DFF) {
+          break; // its output is read in the next cycle
+        }
+        for (auto fix = fanoutStart[wid]; fix < fanoutStart[wid + 1];
+             fix++) {
+          fanout_priority =
+              std::max(fanout_priority, priority[fanoutGates[fix]]);
+        }
+      }
+      priority[*it] = GateBootstrapCost(g.op, xor_mode) + fanout_priority;
+      critical_path = std::max(critical_path, priority[*it]);
+    }
+    std::cout << (mode ? "," : "") << " " << critical_path << " ("
+              << XorModeName(xor_mode) << " xor)";
+  }
+  std::cout << " bootstraps" << std::endl;
+}
+
+const GateIndexList &CompiledCircuit::Priority(XorEnum xor_mode) const {
+  return this->gatePriority[static_cast<unsigned int>(xor_mode)];
+}
+
+bool CompiledCircuit::_ReadCktFile(std::string inFname) {
+  // load a compiled circuit file. The file is memory mapped, and the
+  // gates and CSR fanout table are copied straight out of the mapping
+  std::cout << "Loading compiled circuit " << inFname << std::endl;
+  TIC(auto t_load);
+  CktFileMap ckt;
+  if (!ckt.Open(inFname) || !this->LoadCkt(ckt)) {
+    return false;
+  }
+  std::cout << "### Load time " << TOC_MS(t_load) << " msec ("
+            << this->inputGates.size() + this->allGates.size() << " gates, "
+            << this->n_wires << " wires)" << std::endl;
+  return true;
+}
+
+bool CompiledCircuit::ReadBristolFile(std::string inFname, bool new_flag) {
+  // load a Bristol Fashion circuit directly without assembling it
+  std::cout << "Loading Bristol circuit " << inFname << std::endl;
+  TIC(auto t_load);
+  CktFile ckt;
+  if (!ckt.ReadBristol(inFname, new_flag)) {
+    return false;
+  }
+  unsigned int parse_time = TOC_MS(t_load);
+  if (!this->LoadCkt(ckt.View())) {
+    return false;
+  }
+  std::cout << "### Load time " << TOC_MS(t_load) << " msec (parse "
+            << parse_time << " msec, "
+            << this->inputGates.size() + this->allGates.size() << " gates, "
+            << this->n_wires << " wires)" << std::endl;
+  return true;
+}
+
+bool CompiledCircuit::LoadCkt(const CktView &ckt) {
+  // build the gates and the fanout table from a compiled circuit. They
+  // are built aside and only replace this circuit's once all of the file
+  // checked out, a caller that falls back to the text listing after a
+  // bad file starts from an empty circuit
+  unsigned int gateNo = 0;
+  GateList inputs;
+  inputs.reserve(ckt.n_input_gates);
+  for (uint ix = 0; ix < ckt.n_input_gates; ix++) {
+    const CktFileGate &r = ckt.input_gates[ix];
+    if ((r.out >= ckt.n_wires) || (r.bus >= ckt.n_inputs) ||
+        (r.bit >= ckt.in_bits[r.bus])) {
+      std::cerr << "bad wire in compiled INPUT gate " << ix << std::endl;
+      return false;
+    }
+    Gate g;
+    g.id = gateNo;
+    g.op = GateEnum::INPUT;
+    g.bus = r.bus;
+    g.bit = r.bit;
+    g.outWires.push_back(r.out);
+    gateNo++;
+    inputs.push_back(g);
+  }
+
+  GateList gates;
+  gates.reserve(ckt.n_gates);
+  for (uint ix = 0; ix < ckt.n_gates; ix++) {
+    const CktFileGate &r = ckt.gates[ix];
+    if ((r.op >= N_GATE_OPS) ||
+        (r.op == static_cast<uint32_t>(GateEnum::INPUT)) ||
+        (r.n_in != GateInputCount(static_cast<GateEnum>(r.op)))) {
+      std::cerr << "bad compiled gate " << ix << std::endl;
+      return false;
+    }
+    Gate g;
+    g.op = static_cast<GateEnum>(r.op);
+    g.id = gateNo;
+    for (uint jx = 0; jx < r.n_in; jx++) {
+      if (r.in[jx] >= ckt.n_wires) {
+        std::cerr << "bad input wire in compiled gate " << ix << std::endl;
+        return false;
+      }
+      g.inWires.push_back(r.in[jx]);
+    }
+    if ((g.op == GateEnum::LUT3) || (g.op == GateEnum::LUT4)) {
+      g.table = r.bus;
+    }
+    if (g.op == GateEnum::OUTPUT) {
+      if ((r.bus >= ckt.n_outputs) || (r.bit >= ckt.out_bits[r.bus])) {
+        std::cerr << "bad output bit in compiled gate " << ix << std::endl;
+        return false;
+      }
+      g.bus = r.bus;
+      g.bit = r.bit;
+    } else {
+      if (r.out >= ckt.n_wires) {
+        std::cerr << "bad output wire in compiled gate " << ix << std::endl;
+        return false;
+      }
+      g.outWires.push_back(r.out);
+    }
+    gateNo++;
+    gates.push_back(g);
+  }
+
+  // the fanout table is read without bounds checks during evaluation, so
+  // a file that passed its checksum must still be consistent
+  if ((ckt.fanout_start[0] != 0) ||
+      (ckt.fanout_start[ckt.n_wires] != ckt.n_fanout)) {
+    std::cerr << "bad compiled fanout table" << std::endl;
+    return false;
+  }
+  for (uint ix = 0; ix < ckt.n_wires; ix++) {
+    if (ckt.fanout_start[ix] > ckt.fanout_start[ix + 1]) {
+      std::cerr << "bad compiled fanout of wire " << ix << std::endl;
+      return false;
+    }
+  }
+  for (uint ix = 0; ix < ckt.n_fanout; ix++) {
+    if (ckt.fanout_gates[ix] >= ckt.n_gates) {
+      std::cerr << "bad compiled fanout gate " << ix << std::endl;
+      return false;
+    }
+  }
+
+  this->inputGates.swap(inputs);
+  this->allGates.swap(gates);
+  this->n_wires = ckt.n_wires;
+  this->fanoutStart.assign(ckt.fanout_start,
+                           ckt.fanout_start + ckt.n_wires + 1);
+  this->fanoutGates.assign(ckt.fanout_gates, ckt.fanout_gates + ckt.n_fanout);
+  this->_FindClocked();
+  this->_Levelize();
+  this->_Prioritize();
+
+  this->n_outputs = ckt.n_outputs;
+  this->n_output_bits.assign(ckt.out_bits, ckt.out_bits + ckt.n_outputs);
+  return true;
+}
+
+bool CompiledCircuit::WriteCktFile(std::string outFname) const {
+  // save the loaded circuit as a compiled circuit file
+  CktFile ckt;
+  for (auto const &g : this->inputGates) {
+    ckt.AddInput(g.bus, g.bit, g.outWires[0]);
+  }
+  for (auto const &g : this->allGates) {
+    if (g.op == GateEnum::OUTPUT) {
+      ckt.AddOutput(g.bus, g.bit, g.inWires[0]);
+    } else if ((g.op == GateEnum::LUT3) || (g.op == GateEnum::LUT4)) {
+      ckt.AddLut(g.op, g.inWires, g.table, g.outWires[0]);
+    } else {
+      ckt.AddGate(g.op, g.inWires, g.outWires[0]);
+    }
+  }
+  ckt.n_wires = this->n_wires;
+  ckt.fanout_start = this->fanoutStart;
+  ckt.fanout_gates = this->fanoutGates;
+  std::cout << "Writing compiled circuit " << outFname << std::endl;
+  return ckt.Write(outFname);
+}
+
+std::vector<unsigned int> CompiledCircuit::getInputBits(void) const {
+  // width of each input bus, from the bus and bit of the input gates
+  std::vector<unsigned int> bits;
+  for (auto const &g : this->inputGates) {
+    if (g.bus >= bits.size()) {
+      bits.resize(g.bus + 1, 0);
+    }
+    bits[g.bus] = std::max(bits[g.bus], g.bit + 1);
+  }
+  return bits;
+}
+
+Encoding CompiledCircuit::RequiredEncoding(void) const {
+  // the encoding the keys of an encrypted evaluation must be made for.
+  // AND3/OR3/AND4/OR4 and MAJORITY are native multi-input gates, but
+  // OpenFHE only has a 3 input MAJORITY. LUTs, and a MAJORITY next to 4
+  // input gates, are table lookups. CMUX is built from two input gates
+  unsigned int fan_in = 2;
+  bool lookup = false;
+  bool majority = false;
+  for (auto const &g : this->allGates) {
+    switch (g.op) {
+    case (GateEnum::LUT3):
+    case (GateEnum::LUT4):
+      lookup = true;
+      fan_in = std::max(fan_in, GateInputCount(g.op));
+      break;
+    case (GateEnum::MAJORITY):
+      majority = true;
+      fan_in = std::max(fan_in, GateInputCount(g.op));
+      break;
+    case (GateEnum::AND3):
+    case (GateEnum::OR3):
+    case (GateEnum::AND4):
+    case (GateEnum::OR4):
+      fan_in = std::max(fan_in, GateInputCount(g.op));
+      break;
+    default:
+      break;
+    }
+  }
+  if (lookup || (majority && (fan_in != 3))) {
+    return Encoding(EncodingEnum::FUNCTIONAL, fan_in);
+  }
+  if (fan_in > 2) {
+    return Encoding(EncodingEnum::MULTI_INPUT, fan_in);
+  }
+  return Encoding();
+}
+
+void CompiledCircuit::dumpNetList(void) const {
+  // list each wire by the gate that drives it
+  std::cout << "Netlist " << std::endl;
+  for (auto const *gates : {&this->inputGates, &this->allGates}) {
+    for (auto const &g : *gates) {
+      for (uint ix = 0; ix < g.outWires.size(); ix++) {
+        auto wid = g.outWires[ix];
+        std::cout << "W:" << wid;
+        for (auto fix = fanoutStart[wid]; fix < fanoutStart[wid + 1]; fix++) {
+          std::cout << " " << this->allGates[fanoutGates[fix]].Name();
+        }
+        std::cout << std::endl;
+      }
+    }
+  }
+}
+
+void CompiledCircuit::dumpGates(void) const {
+  std::cout << "Inputlist " << std::endl;
+  for (auto it : this->inputGates) {
+    std::cout << it.Name() << std::endl;
+  }
+  std::cout << "Alllist " << std::endl;
+  for (auto it : this->allGates) {
+    std::cout << it.Name() << std::endl;
+  }
+}
@@ -0,0 +1,139 @@
+// @file compiled.h -- a loaded circuit shared by its evaluations
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other
+// contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+#ifndef SRC_COMPILED_H_
+#define SRC_COMPILED_H_
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cktfile.h"
+#include "gate.h"
+#include "wire.h"
+
+using GateNameList = std::vector<std::string>;
+using GateList = std::vector<Gate>;
+using GateIndexList = std::vector<unsigned int>;
+using GateIndexQueue = std::deque<unsigned int>;
+
+using Inputs = std::vector<std::vector<unsigned int>>;
+using Outputs = std::vector<std::vector<unsigned int>>;
+using EncInputs = std::vector<CipherTextList>;
+using EncOutputs = std::vector<CipherTextList>;
+using WireIdMap = std::unordered_map<std::string, unsigned int>;
+
+// A loaded circuit: its gates, the fanout table and the schedule data
+// derived from them. Nothing in it changes once it is loaded, so one
+// CompiledCircuit can be shared (as a shared_ptr<const CompiledCircuit>)
+// by any number of EvaluationStates running on different threads.
+class CompiledCircuit {
+public:
+  CompiledCircuit();
+  bool ReadFile(std::string cktName);
+  bool ReadBristolFile(std::string cktName, bool new_flag = true);
+  bool WriteCktFile(std::string cktName) const;
+  bool LoadCkt(const CktView &ckt);
+  std::vector<unsigned int> getInputBits(void) const;
+  Encoding RequiredEncoding(void) const;
+  const GateIndexList &Priority(XorEnum xor_mode) const;
+  template <typename T>
+  void SortByPriority(T first, T last, XorEnum xor_mode) const;
+
+  void dumpNetList(void) const;
+  void dumpGates(void) const;
+
+  // full net list of the ckt (all wires and fanout gates) in CSR form
+  // wire w feeds allGates[fanoutGates[fanoutStart[w]..fanoutStart[w+1]-1]]
+  WireIdMap wireIds; // integer id of every register wire in the ckt
+  unsigned int n_wires;
+  GateIndexList fanoutStart;
+  GateIndexList fanoutGates;
+
+  GateList inputGates; // input gates in ckt
+  GateList allGates;   // all other gates in ckt
+
+  // topological levels of allGates, a gate's level is one more than the
+  // highest level of the gates driving it (0 if driven only by inputs)
+  // level l is allGates[levelGates[levelStart[l]..levelStart[l+1]-1]]
+  GateIndexList levelStart;
+  GateIndexList levelGates;
+
+  // bootstraps on the longest path from each gate of allGates to an OUTPUT,
+  // counting the gate itself. When more gates are ready than there are
+  // cores the ones with the highest priority are dispatched first. The
+  // cost of an XOR depends on how it is computed, so there is one table
+  // per XorEnum, gatePriority[xor_mode][gix]
+  std::vector<GateIndexList> gatePriority;
+
+  unsigned int n_outputs;
+  std::vector<unsigned int> n_output_bits;
+
+  // sequential circuits. A DFF latches its input wire when it runs and
+  // drives its output wire with that value at the start of the next
+  // Clock(), so DFF outputs are sources of the dataflow like the inputs.
+  // Gates fed (through any path) by a DFF output are clocked, they are
+  // run every cycle. The other gates only depend on the inputs and are
+  // run only when new inputs are set. heldWires are the wires from that
+  // unclocked part read by clocked gates, they are kept between cycles
+  GateIndexList dffGates;                         // indices into allGates
+  std::unordered_map<unsigned int, unsigned int> dffIndex; // gix to dffGates
+  std::vector<bool> gateClocked;
+  std::vector<bool> wireHeld;
+  GateIndexList heldWires;
+  unsigned int n_clocked_gates;
+
+private:
+  unsigned int _getWireId(std::string);
+  void _GenerateFanout(void);
+  void _FindClocked(void);
+  void _Levelize(void);
+  void _Prioritize(void);
+  bool _ReadCktFile(std::string);
+};
+
+template <typename T>
+void CompiledCircuit::SortByPriority(T first, T last,
+                                     XorEnum xor_mode) const {
+  // order gate indices by decreasing priority, ties keep their order
+  auto const &priority = this->Priority(xor_mode);
+  std::stable_sort(first, last, [&priority](unsigned int a, unsigned int b) {
+    return priority[a] > priority[b];
+  });
+}
+
+#endif // SRC_COMPILED_H_
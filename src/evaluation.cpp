@@ -0,0 +1,937 @@
+// @file evaluation.cpp -- the state of one evaluation of a circuit
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other
+// contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+#include "evaluation.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+#include "utils.h"
+
+EvaluationState::EvaluationState(std::shared_ptr<const CompiledCircuit> ckt,
+                                 lbcrypto::BinFHEContext cc,
+                                 lbcrypto::LWEPrivateKey sk)
+    : ckt(ckt), cc(cc), sk(sk) {
+  this->gep.cc = this->cc;
+  this->gep.sk = this->sk;
+  this->gep.scheme = this->cc.GetLWEScheme();
+  this->gep.mismatches = nullptr;
+  this->schedule = ScheduleEnum::DYNAMIC;
+  this->executor.reset(MakeExecutor(ExecutorEnum::OMP));
+  this->progress_flag = false;
+  this->epoch = 0;
+  this->rearm = true;
+  this->Reset();
+}
+
+EvaluationState::~EvaluationState(void) {}
+
+void EvaluationState::Reset(void) {
+  OPENFHE_DEBUG_FLAG(false);
+
+  // clear counters
+  this->_clearCounts();
+
+  // clear all flags
+  this->plaintext_flag = false;
+  this->encrypted_flag = false;
+  this->verify_flag = false;
+  this->gep.plaintext_flag = false;
+  this->gep.encrypted_flag = false;
+  this->gep.verify_flag = false;
+
+  this->done = false;
+
+  // clear all queues
+  activeWires.clear();
+  executingGates.clear();
+  n_done_gates = 0;
+  n_cycle_gates = this->ckt->allGates.size();
+
+  // start a new epoch, so every wire is undriven and every gate waits on
+  // all of its inputs again. Only a full rearm touches every gate and wire
+  if (this->rearm || ++this->epoch == 0) {
+    this->_Rearm();
+    this->wireCts.assign(this->ckt->n_wires, CipherText());
+    this->wireValues.assign(this->ckt->n_wires, 0);
+  }
+  for (auto wid : this->ckt->heldWires) {
+    this->wireCts[wid] = CipherText();
+  }
+
+  // every DFF starts at 0
+  auto n_dffs = this->ckt->dffGates.size();
+  this->stateValues.assign(n_dffs, 0);
+  this->stateCts.assign(n_dffs, CipherText());
+  this->nextValues.assign(n_dffs, 0);
+  this->nextCts.assign(n_dffs, CipherText());
+  this->n_cycles = 0;
+  this->holding = false;
+  this->state_driven = false;
+  this->n_live_wires = 0;
+  this->max_live_wires = 0;
+
+  this->n_failed_gates = 0;
+  this->circuitOut.resize(this->ckt->n_outputs);
+  this->encOut.resize(this->ckt->n_outputs);
+  for (unsigned int ix = 0; ix < this->ckt->n_outputs; ix++) {
+    this->circuitOut[ix].assign(this->ckt->n_output_bits[ix], 0);
+    this->encOut[ix].assign(this->ckt->n_output_bits[ix], CipherText());
+  }
+  // rearm again unless this evaluation runs to completion
+  this->rearm = true;
+  OPENFHE_DEBUG("reset: epoch " << this->epoch);
+}
+
+void EvaluationState::_Rearm(void) {
+  // clear the input counts of every gate and the stamps of every wire,
+  // and start over at epoch 1. The wire values are left alone, so the
+  // held wires survive a rearm between cycles
+  this->epoch = 1;
+  this->gateArrived.assign(this->ckt->allGates.size(), 0);
+  this->wireEpoch.assign(this->ckt->n_wires, 0);
+  this->wireConsumers.assign(this->ckt->n_wires, 0);
+}
+
+void EvaluationState::_clearCounts(void) {
+  this->n_input_gates = 0;
+  this->n_output_gates = 0;
+  this->n_and_gates = 0;
+  this->n_or_gates = 0;
+  this->n_xor_gates = 0;
+  this->n_not_gates = 0;
+  this->n_dff_gates = 0;
+  this->n_lut_gates = 0;
+  this->n_majority_gates = 0;
+  this->n_cmux_gates = 0;
+  this->n_mismatches.assign(N_GATE_OPS, 0);
+  this->gep.mismatches = this->n_mismatches.data();
+}
+
+void EvaluationState::_NextCycle(bool hold) {
+  // start the next cycle of a circuit clocked since its last Reset. The
+  // flags, the outputs, the DFF state and the held wires carry over. If
+  // hold is set no new inputs are coming and only clocked gates are run
+  OPENFHE_DEBUG_FLAG(false);
+  this->_clearCounts();
+  this->activeWires.clear();
+  this->executingGates.clear();
+  this->n_done_gates = 0;
+  this->n_failed_gates = 0;
+  this->n_cycle_gates =
+      hold ? this->ckt->n_clocked_gates : this->ckt->allGates.size();
+  this->holding = hold;
+  this->state_driven = false;
+  this->done = false;
+  if (this->rearm || ++this->epoch == 0) {
+    this->_Rearm();
+  }
+  this->max_live_wires = this->n_live_wires;
+  this->rearm = true;
+  OPENFHE_DEBUG("cycle " << this->n_cycles << ": epoch " << this->epoch);
+}
+
+void EvaluationState::_driveState(void) {
+  // drive the output wire of every DFF with the value it latched in the
+  // last cycle, once per cycle. When the inputs are held the wires kept
+  // from the unclocked part are fanned out again as well
+  if (this->state_driven) {
+    return;
+  }
+  this->state_driven = true;
+  auto const &dffGates = this->ckt->dffGates;
+  for (unsigned int k = 0; k < dffGates.size(); k++) {
+    auto wid = this->ckt->allGates[dffGates[k]].outWires[0];
+    CipherText ct;
+    if (this->encrypted_flag) {
+      // a trivial encryption of the reset state needs no secret key
+      ct = (this->n_cycles == 0) ? this->cc.EvalConstant(false)
+                                 : this->stateCts[k];
+    }
+    this->_driveWire(wid, this->stateValues[k], ct);
+    this->_activateWire(wid);
+  }
+  if (!this->holding) {
+    return;
+  }
+  for (auto wid : this->ckt->heldWires) {
+    this->_activateWire(wid);
+  }
+  // the unclocked gates are not run, count their inputs as arrived so
+  // they stay in step with the epoch
+  for (unsigned int gix = 0; gix < this->ckt->allGates.size(); gix++) {
+    if (!this->ckt->gateClocked[gix]) {
+      this->gateArrived[gix] += this->ckt->allGates[gix].inWires.size();
+    }
+  }
+}
+
+bool EvaluationState::_arriveInput(unsigned int gix) {
+  // one input of gate gix has been driven, returns true if it was the
+  // last one. seq_cst so the task that runs the gate sees the wires
+  // driven by other workers
+  unsigned int arrived;
+#pragma omp atomic capture seq_cst
+  arrived = ++this->gateArrived[gix];
+  auto n_in = this->ckt->allGates[gix].inWires.size();
+  return arrived == static_cast<unsigned int>(this->epoch * n_in);
+}
+
+void EvaluationState::_activateWire(unsigned int id) {
+  // a wire has been driven, push it on the activeWires queue for the
+  // circuit manager
+  this->activeWires.push_back(id);
+}
+
+void EvaluationState::_driveWire(unsigned int id, unsigned int value,
+                                 CipherText ct) {
+  // store a driven wire in the slab. This and the release functions below
+  // only touch the slot of the wire and atomic counters, so they can be
+  // called from concurrent gate tasks
+  if (this->wireEpoch[id] == this->epoch) {
+    std::cerr << "error wire " << id << " driven more than once" << std::endl;
+  }
+  this->wireEpoch[id] = this->epoch;
+  this->wireValues[id] = value;
+  this->wireCts[id] = ct;
+  if (this->ckt->wireHeld[id]) {
+    return; // kept for the next cycle, not part of the live frontier
+  }
+  // every gate in its fanout reads it once, whatever the last epoch left
+  auto const &fanoutStart = this->ckt->fanoutStart;
+  this->wireConsumers[id] = fanoutStart[id + 1] - fanoutStart[id];
+  unsigned int live, max_live;
+#pragma omp atomic capture
+  live = ++this->n_live_wires;
+#pragma omp atomic read
+  max_live = this->max_live_wires;
+  if (live > max_live) {
+#pragma omp critical(oece_max_live)
+    {
+      if (live > this->max_live_wires) {
+#pragma omp atomic write
+        this->max_live_wires = live;
+      }
+    }
+  }
+  if (this->wireConsumers[id] == 0) { // nothing reads it
+    this->_releaseWire(id);
+  }
+}
+
+void EvaluationState::_releaseWire(unsigned int id) {
+  // the last gate reading this wire is done, free its ciphertext
+  this->wireCts[id] = CipherText();
+#pragma omp atomic
+  this->n_live_wires--;
+}
+
+void EvaluationState::_releaseInputs(const Gate &g) {
+  // this gate no longer needs its inputs, release any wire it was the
+  // last reader of
+  for (uint ix = 0; ix < g.inWires.size(); ix++) {
+    auto wid = g.inWires[ix];
+    if (std::find(g.inWires.begin(), g.inWires.begin() + ix, wid) !=
+        g.inWires.begin() + ix) {
+      continue; // already counted
+    }
+    if (this->ckt->wireHeld[wid]) {
+      continue; // never released
+    }
+    unsigned int remaining;
+#pragma omp atomic capture seq_cst
+    remaining = --this->wireConsumers[wid];
+    if (remaining == 0) {
+      this->_releaseWire(wid);
+    }
+  }
+}
+
+void EvaluationState::SetInput(const Inputs &input, bool verbose) {
+  OPENFHE_DEBUG_FLAG(false);
+  if (this->done) {
+    this->_NextCycle(false); // new inputs for the next cycle
+  }
+  if (this->encrypted_flag && !this->sk) {
+    std::cerr << "Error keyless evaluator cannot encrypt inputs, use "
+              << "SetEncryptedInput" << std::endl;
+    exit(-1);
+  }
+  if (this->encrypted_flag) {
+    this->_CheckEncoding();
+  }
+
+  // parse input;
+  // determine input dimensions
+  auto n_inputs = input.size();
+  std::vector<unsigned int> in_size(n_inputs);
+  size_t ix = 0;
+  size_t total_inputs = 0;
+  size_t total_input_bits = 0;
+  for (auto const &thisin : input) {
+    in_size[ix] = thisin.size();
+    if (verbose)
+      std::cout << "setting input " << ix << " size " << in_size[ix]
+                << std::endl;
+    ix++;
+    total_inputs++;
+    total_input_bits += thisin.size();
+  }
+
+  if (verbose)
+    std::cout << "set input total of " << total_inputs << " inputs"
+              << std::endl;
+  size_t inputs_used = 0;
+  this->n_input_gates = 0;
+  // for each gate on input gate list
+  for (auto const &g : this->ckt->inputGates) {
+    OPENFHE_DEBUG("parsing gate " << g.Name());
+    unsigned int value = input[g.bus][g.bit];
+    this->n_input_gates++;
+    // create output wires from gate output list
+    for (uint out_ix = 0; out_ix < g.outWires.size(); out_ix++) {
+      OPENFHE_DEBUG("in setInput setting wire " << g.outWires[out_ix]
+                                                << " to " << value);
+      CipherText ct;
+      if (encrypted_flag) {
+        ct = this->cc.Encrypt(this->sk, value, lbcrypto::BOOTSTRAPPED,
+                              PlaintextModulus(this->gep.encoding));
+      }
+      // push onto activeWires queue
+      this->_driveWire(g.outWires[out_ix], value, ct);
+      this->_activateWire(g.outWires[out_ix]);
+      inputs_used++;
+    }
+  }
+  if (total_input_bits != inputs_used) {
+    std::cerr << "error: total_inputs: " << total_input_bits
+              << " #used: " << inputs_used << std::endl;
+  } else {
+    if (verbose)
+      std::cout << "input confirmed" << std::endl;
+  }
+}
+
+void EvaluationState::SetEncryptedInput(const EncInputs &input) {
+  // drive the input wires with ciphertexts encrypted by the client, the
+  // inputs are laid out like the Inputs of SetInput
+  if (!this->encrypted_flag || this->plaintext_flag) {
+    std::cerr << "Error encrypted inputs need the encrypted flag only"
+              << std::endl;
+    exit(-1);
+  }
+  this->_CheckEncoding();
+  if (this->done) {
+    this->_NextCycle(false); // new inputs for the next cycle
+  }
+  this->n_input_gates = 0;
+  for (auto const &g : this->ckt->inputGates) {
+    unsigned int in_num = g.bus;
+    unsigned int bit_num = g.bit;
+    if ((in_num >= input.size()) || (bit_num >= input[in_num].size())) {
+      std::cerr << "error: no encrypted input " << in_num << " bit "
+                << bit_num << std::endl;
+      exit(-1);
+    }
+    this->n_input_gates++;
+    for (auto wid : g.outWires) {
+      this->_driveWire(wid, 0, input[in_num][bit_num]);
+      this->_activateWire(wid);
+    }
+  }
+}
+
+Outputs EvaluationState::Clock(void) {
+  TIC(auto t_total);
+  unsigned int management_time = 0;
+  unsigned int execution_time = 0;
+  unsigned int total_time = 0;
+
+  if (this->done) {
+    this->_NextCycle(true); // no new inputs, hold the last ones
+  }
+  this->_driveState();
+  if (this->schedule == ScheduleEnum::LEVEL) {
+    TIC(auto t_execution);
+    _ExecuteLevels();
+    execution_time += TOC_MS(t_execution);
+    this->done = true;
+  } else if (this->schedule == ScheduleEnum::ASYNC) {
+    TIC(auto t_execution);
+    _ExecuteAsync();
+    execution_time += TOC_MS(t_execution);
+    this->done = true;
+  }
+  while (!this->activeWires.empty() && !this->done) {
+    if (this->progress_flag) {
+      std::cout << "\r                            " << std::flush;
+      std::cout << "\r managing... " << std::flush;
+    }
+    TIC(auto t_management);
+    _CircuitManager(); // puts tasks on executingGate
+    management_time += TOC_MS(t_management);
+    // returns when none are left
+    if (this->progress_flag) {
+      std::cout << "\r                            " << std::flush;
+      std::cout << "\r executing... " << std::flush;
+    }
+    TIC(auto t_execution);
+    _ExecuteGates();
+    execution_time += TOC_MS(t_execution);
+    if (n_done_gates == this->n_cycle_gates) {
+      this->done = true;
+    }
+  }
+  // the DFFs take the values latched in this cycle, and the next Clock()
+  // starts a new cycle
+  this->stateValues = this->nextValues;
+  this->stateCts = this->nextCts;
+  this->n_cycles++;
+  this->done = true;
+  // the input counts are exact only if every gate counted its inputs
+  this->rearm = (this->n_done_gates != this->n_cycle_gates);
+  total_time = TOC_MS(t_total);
+  // if very fast circuits...
+  if (execution_time == 0)
+    execution_time = 1;
+  if (total_time == 0)
+    total_time = 1;
+
+  std::cout << std::endl
+            << "### Total time " << total_time << " msec" << std::endl;
+  std::cout << "### Peak live wires " << this->max_live_wires << " of "
+            << this->ckt->n_wires << std::endl;
+  if (this->n_failed_gates > 0) {
+    std::cout << "### " << this->n_failed_gates << " gates failed"
+              << std::endl;
+  }
+  for (unsigned int op = 0; op < N_GATE_OPS; op++) {
+    if (this->n_mismatches[op] > 0) {
+      auto gate_op = static_cast<GateEnum>(op);
+      std::cout << "### " << this->n_mismatches[op] << " "
+                << GateOpName(gate_op) << " mismatches";
+      if (gate_op == GateEnum::XOR) {
+        std::cout << " (" << XorModeName(this->gep.xor_mode) << " xor)";
+      }
+      std::cout << std::endl;
+    }
+  }
+  std::cout << std::endl
+            << "efficiency "
+            << float(execution_time) / float(total_time) * 100.0 << "%"
+            << std::endl;
+
+  return this->circuitOut;
+}
+
+void EvaluationState::_CircuitManager(void) {
+  OPENFHE_DEBUG_FLAG(false);
+
+  // the basic flow is:
+  // for each active wire pop it of the active queue
+  //  for each gate in the wire's fanout
+  //    decrement the gate's pending input count for every input the
+  //    wire drives
+  //    if no inputs are pending put the gate on the execute queue
+  // so each wire costs O(fanout) regardless of the size of the circuit
+
+  auto const &fanoutStart = this->ckt->fanoutStart;
+  auto const &fanoutGates = this->ckt->fanoutGates;
+  OPENFHE_DEBUG("@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@");
+  while (!this->activeWires.empty()) {
+    OPENFHE_DEBUG("CM top aw: " << activeWires.size());
+
+    auto wid = this->activeWires.front();
+    this->activeWires.pop_front();
+
+    for (auto fix = fanoutStart[wid]; fix < fanoutStart[wid + 1]; fix++) {
+      auto gix = fanoutGates[fix];
+      const Gate &g = this->ckt->allGates[gix];
+      OPENFHE_DEBUG("  found gate " << g.Name() << " in fanout");
+      if (this->holding && !this->ckt->gateClocked[gix]) {
+        continue; // the inputs are held, its outputs are still valid
+      }
+      for (auto iw : g.inWires) {
+        // each wire is activated once, the value stays in the slab
+        if ((iw == wid) && this->_arriveInput(gix)) {
+          this->executingGates.push_back(gix);
+          OPENFHE_DEBUG("  ->execute:  " << this->executingGates.size());
+        }
+      }
+    }
+    OPENFHE_DEBUG("wire done " << wid);
+  } // while active wire is not empty
+  OPENFHE_DEBUG("Manager Done Cycle");
+  // active wire was empty. return so we can cycle again.
+}
+
+void EvaluationState::_ExecuteGates(void) {
+  OPENFHE_DEBUG_FLAG(false);
+  // For each gate on the executeGate queue in parallel
+  OPENFHE_DEBUG("Execute start Cycle");
+
+  // tasks are created in priority order so the gates on the critical path
+  // start first when there are more ready gates than cores
+  this->ckt->SortByPriority(this->executingGates.begin(),
+                            this->executingGates.end(), this->gep.xor_mode);
+
+  // all gates on the executingGates queue can be Evaluated in parallel
+  TaskIndexList batch(this->executingGates.begin(),
+                      this->executingGates.end());
+  this->executingGates.clear();
+  this->executor->Run(
+      batch, [this](unsigned int gix) { this->_EvaluateGate(gix); },
+      this->_priorityOf());
+
+  // hand the wires they drove to the circuit manager
+  OPENFHE_DEBUG("done parallel gate");
+  for (auto gix : batch) {
+    if (this->ckt->allGates[gix].op == GateEnum::DFF) {
+      continue; // its output is driven in the next cycle
+    }
+    for (auto wid : this->ckt->allGates[gix].outWires) {
+      this->_activateWire(wid);
+    }
+  }
+  OPENFHE_DEBUG("Execute done Cycle");
+  if (this->progress_flag) {
+    std::cout << "\rProcessing: " << this->n_done_gates << " of "
+              << this->ckt->allGates.size() << std::flush;
+  }
+}
+
+void EvaluationState::_countGate(const Gate &g) {
+  switch (g.op) {
+  case (GateEnum::INPUT):
+#pragma omp atomic
+    this->n_input_gates++;
+    break;
+  case (GateEnum::OUTPUT):
+#pragma omp atomic
+    this->n_output_gates++;
+    break;
+  case (GateEnum::NOT):
+#pragma omp atomic
+    this->n_not_gates++;
+    break;
+  case (GateEnum::AND):
+  case (GateEnum::AND3):
+  case (GateEnum::AND4):
+#pragma omp atomic
+    this->n_and_gates++;
+    break;
+  case (GateEnum::OR):
+  case (GateEnum::OR3):
+  case (GateEnum::OR4):
+#pragma omp atomic
+    this->n_or_gates++;
+    break;
+  case (GateEnum::XOR):
+#pragma omp atomic
+    this->n_xor_gates++;
+    break;
+  case (GateEnum::DFF):
+#pragma omp atomic
+    this->n_dff_gates++;
+    break;
+  case (GateEnum::LUT3):
+  case (GateEnum::LUT4):
+#pragma omp atomic
+    this->n_lut_gates++;
+    break;
+  case (GateEnum::MAJORITY):
+#pragma omp atomic
+    this->n_majority_gates++;
+    break;
+  case (GateEnum::CMUX):
+#pragma omp atomic
+    this->n_cmux_gates++;
+    break;
+  default:
+    std::cerr << "bad gate eval" << std::endl;
+  }
+}
+
+void EvaluationState::_storeOutput(const Gate &g, const BitList &plainout,
+                                   const CipherTextList &encout) {
+  // right now outputs are output, bit, and single value
+  auto out_num = g.bus;
+  auto bit_num = g.bit;
+  auto &bit = circuitOut[out_num][bit_num];
+  if (encrypted_flag) {
+    this->encOut[out_num][bit_num] = encout[0];
+    if (this->sk && encout[0]) { // a keyless evaluator leaves it encrypted
+      lbcrypto::LWEPlaintext res;
+      this->cc.Decrypt(this->sk, encout[0], &res,
+                       PlaintextModulus(this->gep.encoding));
+      bit = res;
+    }
+  } else {
+    if (!plaintext_flag) {
+      std::cerr << "Error either encrypted or plaintext flag must be set"
+                << std::endl;
+    }
+    bit = plainout[0];
+  }
+  // deliver the bit now, while the rest of the circuit is still running
+  if (this->outputCallback) {
+    this->outputCallback(out_num, bit_num, bit,
+                         encrypted_flag ? encout[0] : CipherText());
+  }
+}
+
+void EvaluationState::_EvaluateGate(unsigned int gix) {
+  // evaluate one gate on the wire values in the slab, drive its output
+  // wires (or the circuit outputs) and release the inputs it was the last
+  // reader of. The gate's inputs and outputs live on this stack frame, so
+  // any number of gates can be evaluated at once
+  OPENFHE_DEBUG_FLAG(false);
+  const Gate &g = this->ckt->allGates[gix];
+  OPENFHE_DEBUG("processing gate " << g.Name());
+  auto n_in = g.inWires.size();
+  BitList plainin(n_in);
+  CipherTextList encin(n_in);
+  for (uint ix = 0; ix < n_in; ix++) {
+    plainin[ix] = this->wireValues[g.inWires[ix]];
+    encin[ix] = this->wireCts[g.inWires[ix]];
+  }
+  BitList plainout;
+  CipherTextList encout;
+  bool ok = false;
+  // a missing input ciphertext means an earlier gate failed
+  if (!this->encrypted_flag ||
+      std::find(encin.begin(), encin.end(), CipherText()) == encin.end()) {
+    try {
+      ok = g.Evaluate(this->gep, plainin, encin, &plainout, &encout);
+    } catch (...) {
+      std::cerr << "throw!! executing gate FAILED " << g.Name() << std::endl;
+    }
+  }
+  if (!ok) {
+    // the encrypted outputs are lost, the plaintext ones can still be run
+    GateEvalParams plain_gep(this->gep);
+    plain_gep.encrypted_flag = false;
+    plain_gep.verify_flag = false;
+    plain_gep.mismatches = nullptr;
+    plainout.clear();
+    g.Evaluate(plain_gep, plainin, encin, &plainout, &encout);
+    encout.assign(g.op == GateEnum::OUTPUT ? 1 : g.outWires.size(),
+                  CipherText());
+#pragma omp atomic
+    this->n_failed_gates++;
+  }
+  this->_countGate(g);
+
+  if (g.op == GateEnum::OUTPUT) { // output gates do not generate output wires
+    this->_storeOutput(g, plainout, encout);
+  } else if (g.op == GateEnum::DFF) {
+    // latch for the next cycle, the output wire of this one was driven
+    // from the last
+    auto k = this->ckt->dffIndex.at(gix);
+    this->nextValues[k] = this->plaintext_flag ? plainout[0] : 0;
+    this->nextCts[k] = this->encrypted_flag ? encout[0] : CipherText();
+  } else {
+    for (uint out_ix = 0; out_ix < g.outWires.size(); out_ix++) {
+      unsigned int value(0);
+      CipherText ct;
+      if (this->plaintext_flag) {
+        value = plainout[out_ix];
+      }
+      if (this->encrypted_flag) {
+        ct = encout[out_ix];
+      }
+      this->_driveWire(g.outWires[out_ix], value, ct);
+    }
+  }
+
+  this->_releaseInputs(g);
+#pragma omp atomic
+  this->n_done_gates++;
+}
+
+void EvaluationState::_ExecuteLevels(void) {
+  // run the gates one level at a time. Every input of a gate in level l is
+  // driven by a lower level, so each level is one parallel run with no
+  // search for ready gates.
+  this->activeWires.clear(); // not used, the levels give the order
+  auto const &levelStart = this->ckt->levelStart;
+  auto const &levelGates = this->ckt->levelGates;
+  for (unsigned int lix = 0; lix + 1 < levelStart.size(); lix++) {
+    TaskIndexList level;
+    for (auto ix = levelStart[lix]; ix < levelStart[lix + 1]; ix++) {
+      // while the inputs are held only the clocked gates are run
+      auto gix = levelGates[ix];
+      if (!this->holding || this->ckt->gateClocked[gix]) {
+        level.push_back(gix);
+        // count its inputs as arrived, as the circuit manager would, so
+        // the next Reset only needs to advance the epoch
+        this->gateArrived[gix] += this->ckt->allGates[gix].inWires.size();
+      }
+    }
+    // the most critical gates of the level go first
+    this->ckt->SortByPriority(level.begin(), level.end(), this->gep.xor_mode);
+    this->executor->Run(
+        level, [this](unsigned int gix) { this->_EvaluateGate(gix); },
+        this->_priorityOf());
+    if (this->progress_flag) {
+      std::cout << "\rProcessing: " << this->n_done_gates << " of "
+                << this->ckt->allGates.size() << std::flush;
+    }
+  }
+}
+
+void EvaluationState::_ExecuteAsync(void) {
+  // the gates fed only by the inputs set by SetInput are found by the
+  // circuit manager, after that every gate task spawns its own ready
+  // successors, so evaluation never waits for a batch to finish
+  TaskIndexList ready = this->ReadyGates();
+  this->executor->Run(
+      ready,
+      [this](unsigned int gix) {
+        GateIndexList readyGates;
+        this->RunGate(gix, &readyGates);
+        this->executor->Spawn(readyGates);
+      },
+      this->_priorityOf());
+}
+
+GateIndexList EvaluationState::ReadyGates(void) {
+  // the gates whose inputs have all been driven, most critical first
+  this->_driveState();
+  this->_CircuitManager();
+  GateIndexList ready(this->executingGates.begin(),
+                      this->executingGates.end());
+  this->executingGates.clear();
+  this->ckt->SortByPriority(ready.begin(), ready.end(), this->gep.xor_mode);
+  return ready;
+}
+
+void EvaluationState::RunGate(unsigned int gix, GateIndexList *readyGates) {
+  // evaluate one gate and append every fanout gate whose last pending
+  // input it drove to readyGates, most critical first
+  this->_EvaluateGate(gix);
+  if (this->ckt->allGates[gix].op == GateEnum::DFF) {
+    return; // its output is driven in the next cycle
+  }
+  auto const &fanoutStart = this->ckt->fanoutStart;
+  auto const &fanoutGates = this->ckt->fanoutGates;
+  auto first = readyGates->size();
+  for (auto wid : this->ckt->allGates[gix].outWires) {
+    for (auto fix = fanoutStart[wid]; fix < fanoutStart[wid + 1]; fix++) {
+      unsigned int next = fanoutGates[fix];
+      for (auto iw : this->ckt->allGates[next].inWires) {
+        if (iw != wid) {
+          continue;
+        }
+        if (!this->_arriveInput(next)) {
+          continue;
+        }
+        if (this->ckt->allGates[next].op == GateEnum::OUTPUT) {
+          // cheap and feeds nothing, deliver it now rather than after
+          // the queued gates
+          this->_EvaluateGate(next);
+        } else {
+          readyGates->push_back(next);
+        }
+      }
+    }
+  }
+  this->ckt->SortByPriority(readyGates->begin() + first, readyGates->end(),
+                            this->gep.xor_mode);
+}
+
+Outputs EvaluationState::getOutputs(void) { return this->circuitOut; }
+
+EncOutputs EvaluationState::getEncryptedOutputs(void) { return this->encOut; }
+
+unsigned int EvaluationState::getFailedGates(void) {
+  return this->n_failed_gates;
+}
+
+unsigned int EvaluationState::getMismatches(GateEnum op) {
+  return this->n_mismatches[static_cast<unsigned int>(op)];
+}
+
+TaskPriority EvaluationState::_priorityOf(void) {
+  // priority of a gate index for the executor, with the XOR mode in use
+  auto priority = &this->ckt->Priority(this->gep.xor_mode);
+  return [priority](unsigned int gix) { return (*priority)[gix]; };
+}
+
+void EvaluationState::setPlaintext(bool input) {
+  this->plaintext_flag = input;
+  this->gep.plaintext_flag = this->plaintext_flag;
+}
+
+bool EvaluationState::getPlaintext(void) { return (this->plaintext_flag); }
+
+void EvaluationState::setEncrypted(bool input) {
+  this->encrypted_flag = input;
+  this->gep.encrypted_flag = this->encrypted_flag;
+}
+
+bool EvaluationState::getEncrypted(void) { return (this->encrypted_flag); }
+
+void EvaluationState::setVerify(bool input) {
+  if (input && !this->sk) {
+    std::cerr << "Error keyless evaluator cannot verify" << std::endl;
+    exit(-1);
+  }
+  this->verify_flag = input;
+  this->gep.verify_flag = this->verify_flag;
+  if (input) { // note in order to verify both flags must also be true
+    this->setPlaintext(true);
+    this->setEncrypted(true);
+  }
+}
+
+bool EvaluationState::getVerify(void) { return (this->verify_flag); }
+
+std::string ScheduleName(ScheduleEnum schedule) {
+  switch (schedule) {
+  case (ScheduleEnum::DYNAMIC):
+    return "DYNAMIC";
+  case (ScheduleEnum::LEVEL):
+    return "LEVEL";
+  case (ScheduleEnum::ASYNC):
+    return "ASYNC";
+  default:
+    return "BAD";
+  }
+}
+
+void EvaluationState::setSchedule(ScheduleEnum input) {
+  this->schedule = input;
+}
+
+ScheduleEnum EvaluationState::getSchedule(void) { return (this->schedule); }
+
+void EvaluationState::setExecutor(std::shared_ptr<Executor> input) {
+  this->executor = input;
+}
+
+void EvaluationState::setOutputCallback(OutputCallback input) {
+  this->outputCallback = input;
+}
+
+void EvaluationState::setProgress(bool input) { this->progress_flag = input; }
+
+void EvaluationState::setXorMode(XorEnum input) {
+  this->gep.xor_mode = input;
+}
+
+XorEnum EvaluationState::getXorMode(void) { return (this->gep.xor_mode); }
+
+void EvaluationState::setEncoding(const Encoding &input) {
+  this->gep.encoding = input;
+  this->_BuildLuts();
+}
+
+Encoding EvaluationState::getEncoding(void) { return (this->gep.encoding); }
+
+// the identity on the plaintext space, as a plain function for
+// GenerateLUTviaFunction
+static lbcrypto::NativeInteger lut_identity(lbcrypto::NativeInteger m,
+                                            lbcrypto::NativeInteger) {
+  return m;
+}
+
+void EvaluationState::_BuildLuts(void) {
+  // the FUNCTIONAL encoding evaluates every gate with a truth table with
+  // EvalFunc, make its lookup table once for each truth table in the
+  // circuit. A lookup table has an entry for every phase mod q, entry i
+  // holds the encoding of f(i / (q / p)). GenerateLUTviaFunction only
+  // takes a plain function, so the table of the identity is generated
+  // and its entries are mapped through each truth table
+  this->luts.clear();
+  this->gep.luts = nullptr;
+  if (this->gep.encoding.kind != EncodingEnum::FUNCTIONAL) {
+    return;
+  }
+  auto p = PlaintextModulus(this->gep.encoding);
+  LutTable identity;
+  for (auto const &g : this->ckt->allGates) {
+    unsigned int table;
+    if (!g.TruthTable(&table) || this->luts.count(table)) {
+      continue;
+    }
+    if (identity.empty()) {
+      identity = this->cc.GenerateLUTviaFunction(lut_identity, p);
+    }
+    uint64_t interval = identity.size() / p;
+    LutTable &lut = this->luts[table];
+    lut.reserve(identity.size());
+    for (auto const &entry : identity) {
+      uint64_t m = entry.ConvertToInt() / interval;
+      lut.push_back(lbcrypto::NativeInteger(((table >> m) & 1) * interval));
+    }
+  }
+  this->gep.luts = &this->luts;
+}
+
+void EvaluationState::_CheckEncoding(void) {
+  // the bits must be encoded the way the gates of the circuit need, a
+  // LUT on keys made for the BOOLEAN encoding would decrypt to garbage
+  auto need = this->ckt->RequiredEncoding();
+  if (need != this->gep.encoding) {
+    std::cerr << "Error the circuit needs keys made for the "
+              << EncodingName(need) << " encoding, these are made for "
+              << EncodingName(this->gep.encoding) << std::endl;
+    exit(-1);
+  }
+}
+
+void EvaluationState::dumpGateCount(void) {
+  std::cout << "Number of input gates " << this->n_input_gates << std::endl;
+  std::cout << "Number of output gates " << this->n_output_gates << std::endl;
+  std::cout << "Number of not gates " << this->n_not_gates << std::endl;
+  std::cout << "Number of and gates " << this->n_and_gates << std::endl;
+  std::cout << "Number of or gates " << this->n_or_gates << std::endl;
+  std::cout << "Number of xor gates " << this->n_xor_gates << std::endl;
+  if (!this->ckt->dffGates.empty()) {
+    std::cout << "Number of dff gates " << this->n_dff_gates << std::endl;
+  }
+  if (this->n_lut_gates) {
+    std::cout << "Number of lut gates " << this->n_lut_gates << std::endl;
+  }
+  if (this->n_majority_gates) {
+    std::cout << "Number of majority gates " << this->n_majority_gates
+              << std::endl;
+  }
+  if (this->n_cmux_gates) {
+    std::cout << "Number of cmux gates " << this->n_cmux_gates << std::endl;
+  }
+}
@@ -0,0 +1,218 @@
+// @file evaluation.h -- the state of one evaluation of a circuit
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other
+// contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+#ifndef SRC_EVALUATION_H_
+#define SRC_EVALUATION_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "compiled.h"
+#include "executor.h"
+#include "gate.h"
+#include "wire.h"
+
+// how Clock() schedules the gates of the circuit
+//   DYNAMIC the circuit manager finds the gates made ready by the wires
+//           driven in the last round and executes them as the next batch
+//   LEVEL   the gates are run one level at a time, using the levels
+//           computed when the circuit was loaded
+//   ASYNC   a worker that finishes a gate launches every fanout gate it
+//           made ready right away, there are no rounds or barriers
+enum class ScheduleEnum { DYNAMIC, LEVEL, ASYNC };
+
+std::string ScheduleName(ScheduleEnum schedule);
+
+// called with the bus, bit, value and ciphertext of each output bit as
+// soon as its OUTPUT gate has run, from whichever thread ran it, so it
+// must be thread safe. value is the plaintext or decrypted bit (0 on a
+// keyless evaluator), ct is null unless the evaluation is encrypted
+using OutputCallback =
+    std::function<void(unsigned int bus, unsigned int bit, unsigned int value,
+                       const CipherText &ct)>;
+
+// The wire values and gate counters of one evaluation of a loaded
+// circuit. The CompiledCircuit is only read, so any number of states on
+// different threads can share one circuit. A state runs one Clock() at
+// a time, on its own executor.
+//
+// A state made with a null secret key is a keyless evaluator: it takes
+// inputs encrypted by a CircuitClient with SetEncryptedInput() and hands
+// back encrypted outputs with getEncryptedOutputs(). It never decrypts,
+// so verify mode is not available, and a gate that fails is counted
+// (see getFailedGates()) instead of being repaired.
+//
+// A circuit with DFFs is sequential. Each Clock() is one cycle: the DFF
+// outputs are driven with the values latched by the last cycle (0 after
+// a Reset) and the DFFs latch their inputs for the next one. Clock() can
+// be called again without a Reset. If SetInput() (or SetEncryptedInput())
+// is called first the whole circuit is run on the new inputs, otherwise
+// the inputs are held and only the gates fed by a DFF are run.
+class EvaluationState {
+public:
+  EvaluationState(std::shared_ptr<const CompiledCircuit> ckt,
+                  lbcrypto::BinFHEContext cc, lbcrypto::LWEPrivateKey sk);
+  ~EvaluationState();
+  void Reset(void);
+  void SetInput(const Inputs &input, bool verbose = false);
+  void SetEncryptedInput(const EncInputs &input);
+  Outputs Clock(void);
+  void setPlaintext(bool);
+  bool getPlaintext(void);
+  void setEncrypted(bool);
+  bool getEncrypted(void);
+  void setVerify(bool);
+  bool getVerify(void);
+  void setSchedule(ScheduleEnum);
+  ScheduleEnum getSchedule(void);
+  void setExecutor(std::shared_ptr<Executor>);
+  void setOutputCallback(OutputCallback);
+  // a state only writes its progress while clocking if this is set, so
+  // states run on several threads do not all write to std::cout
+  void setProgress(bool);
+  void setXorMode(XorEnum);
+  XorEnum getXorMode(void);
+  // the encoding the keys were made for, an encrypted evaluation stops
+  // with an error if it is not the one the circuit needs
+  void setEncoding(const Encoding &);
+  Encoding getEncoding(void);
+  void dumpGateCount(void);
+
+  // for running the gates of several states in one executor run: after
+  // SetInput, ReadyGates lists the gates that can run, RunGate runs one
+  // of them and adds the gates it made ready, and getOutputs returns the
+  // result once every gate has run
+  GateIndexList ReadyGates(void);
+  void RunGate(unsigned int gix, GateIndexList *readyGates);
+  Outputs getOutputs(void);
+  EncOutputs getEncryptedOutputs(void);
+  unsigned int getFailedGates(void);
+  // gates of type op whose encrypted output did not match the plaintext
+  // one in verify mode, since the last Reset or cycle
+  unsigned int getMismatches(GateEnum op);
+
+private:
+  std::shared_ptr<const CompiledCircuit> ckt;
+  lbcrypto::BinFHEContext cc;
+  lbcrypto::LWEPrivateKey sk;
+  GateEvalParams gep;
+  LutMap luts; // FUNCTIONAL encoding, built once by setEncoding()
+
+  bool plaintext_flag; // if true perform plaintext logic
+  bool encrypted_flag; // if true perform encrypted logic
+  bool verify_flag;    // if true verify plaintext vs encrypted logic
+  ScheduleEnum schedule;
+  std::shared_ptr<Executor> executor; // runs the gates of every schedule
+  OutputCallback outputCallback;      // if set, gets each output bit early
+  bool progress_flag;                 // if true show progress in Clock()
+
+  WireIdQueue activeWires; // wires driven but not yet fanned out
+
+  // slab of wire values indexed by wire id. A ciphertext slot is filled
+  // when its wire is driven and released when the last gate in its fanout
+  // has been evaluated, so only the live frontier of the ckt is in memory
+  CipherTextList wireCts;
+  BitList wireValues;
+  GateIndexList wireConsumers; // fanout gates of each wire not yet evaluated
+
+  // Reset only advances the epoch, nothing is rebuilt per evaluation. A
+  // wire has been driven in this evaluation if its wireEpoch is the
+  // current epoch. gateArrived counts the inputs a gate has received over
+  // all evaluations since the last full rearm, so the gate is ready when
+  // the count reaches epoch * (number of inputs). This holds as long as
+  // every earlier evaluation ran to completion, otherwise Reset rearms
+  // everything. A LEVEL run counts the inputs of each gate it runs.
+  unsigned int epoch;
+  bool rearm;
+  GateIndexList wireEpoch;
+  GateIndexList gateArrived;
+  unsigned int n_live_wires;
+  unsigned int max_live_wires;
+
+  GateIndexQueue executingGates; // indices into allGates ready to run
+  unsigned int n_done_gates;
+  unsigned int n_cycle_gates; // gates run in this cycle
+  bool done;
+
+  // DFF state, indexed like ckt->dffGates. A DFF writes next* when it
+  // runs, the end of the cycle copies next* to state*
+  BitList stateValues;
+  CipherTextList stateCts;
+  BitList nextValues;
+  CipherTextList nextCts;
+  unsigned int n_cycles; // cycles clocked since the last Reset
+  bool holding;          // the inputs of the last cycle are held
+  bool state_driven;     // the DFF outputs of this cycle are driven
+
+  void _BuildLuts(void);
+  void _CheckEncoding(void);
+  void _Rearm(void);
+  void _NextCycle(bool);
+  void _driveState(void);
+  void _clearCounts(void);
+  bool _arriveInput(unsigned int);
+  void _activateWire(unsigned int);
+  void _driveWire(unsigned int, unsigned int, CipherText);
+  void _releaseWire(unsigned int);
+  void _releaseInputs(const Gate &);
+  void _countGate(const Gate &);
+  void _storeOutput(const Gate &, const BitList &, const CipherTextList &);
+  void _EvaluateGate(unsigned int);
+  void _CircuitManager(void);
+  void _ExecuteGates(void);
+  void _ExecuteLevels(void);
+  void _ExecuteAsync(void);
+  TaskPriority _priorityOf(void);
+
+  Outputs circuitOut;
+  EncOutputs encOut;
+  unsigned int n_failed_gates; // encrypted gates that could not be computed
+  std::vector<unsigned int> n_mismatches; // verify failures by gate op
+
+  unsigned int n_input_gates;
+  unsigned int n_output_gates;
+  unsigned int n_and_gates;
+  unsigned int n_or_gates;
+  unsigned int n_xor_gates;
+  unsigned int n_not_gates;
+  unsigned int n_dff_gates;
+  unsigned int n_lut_gates;
+  unsigned int n_majority_gates;
+  unsigned int n_cmux_gates;
+};
+
+#endif // SRC_EVALUATION_H_
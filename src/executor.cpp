@@ -0,0 +1,364 @@
+// @file executor.cpp -- backends that run the gate tasks of a circuit
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other
+// contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+#include "executor.h"
+
+#include <algorithm>
+#include <iostream>
+
+Executor::~Executor(void) {}
+
+std::string ExecutorName(ExecutorEnum kind) {
+  switch (kind) {
+  case (ExecutorEnum::OMP):
+    return "OMP";
+  case (ExecutorEnum::POOL):
+    return "POOL";
+  case (ExecutorEnum::SERIAL):
+    return "SERIAL";
+  default:
+    return "BAD";
+  }
+}
+
+Executor *MakeExecutor(ExecutorEnum kind, unsigned int n_threads) {
+  switch (kind) {
+  case (ExecutorEnum::OMP):
+    return new OmpExecutor();
+  case (ExecutorEnum::POOL):
+    return new PoolExecutor(n_threads);
+  case (ExecutorEnum::SERIAL):
+    return new SerialExecutor();
+  default:
+    std::cerr << "bad executor" << std::endl;
+    exit(-1);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+// priority queue of tasks
+
+TaskHeap::TaskHeap(void) : seq(0) {}
+
+bool TaskHeap::Entry::operator<(const Entry &other) const {
+  // std::push_heap keeps the greatest entry on top
+  if (this->priority != other.priority) {
+    return this->priority < other.priority;
+  }
+  return this->seq < other.seq;
+}
+
+void TaskHeap::Push(unsigned int ix, unsigned int priority) {
+  Entry e;
+  e.priority = priority;
+  e.seq = this->seq++;
+  e.ix = ix;
+  this->heap.push_back(e);
+  std::push_heap(this->heap.begin(), this->heap.end());
+}
+
+unsigned int TaskHeap::Pop(void) {
+  std::pop_heap(this->heap.begin(), this->heap.end());
+  auto ix = this->heap.back().ix;
+  this->heap.pop_back();
+  return ix;
+}
+
+bool TaskHeap::Top(unsigned int *priority) const {
+  if (this->heap.empty()) {
+    return false;
+  }
+  *priority = this->heap.front().priority;
+  return true;
+}
+
+bool TaskHeap::Empty(void) const { return this->heap.empty(); }
+
+void TaskHeap::Clear(void) { this->heap.clear(); }
+
+////////////////////////////////////////////////////////////////////////
+// OpenMP tasks
+
+void OmpExecutor::Run(const TaskIndexList &ready, const TaskFunction &task,
+                      const TaskPriority &priority) {
+  this->task = &task;
+  this->priority = &priority;
+#pragma omp parallel
+  {
+#pragma omp single
+    this->Spawn(ready);
+  } // all tasks, including the ones they spawned, are done here
+}
+
+void OmpExecutor::Spawn(const TaskIndexList &ready) {
+  for (auto ix : ready) {
+    this->_Task(ix);
+  }
+}
+
+void OmpExecutor::_Task(unsigned int ix) {
+  // with OpenMP 4.5 the priority is passed on to the runtime, it is
+  // honoured up to OMP_MAX_TASK_PRIORITY
+#if _OPENMP >= 201511
+  int prio = (*this->priority)(ix);
+#pragma omp task firstprivate(ix) priority(prio)
+#else
+#pragma omp task firstprivate(ix)
+#endif
+  (*this->task)(ix);
+}
+
+std::string OmpExecutor::Name(void) { return "OMP"; }
+
+////////////////////////////////////////////////////////////////////////
+// inline on the calling thread
+
+void SerialExecutor::Run(const TaskIndexList &ready, const TaskFunction &task,
+                         const TaskPriority &priority) {
+  this->priority = &priority;
+  this->queue.Clear();
+  this->_Queue(ready);
+  while (!this->queue.Empty()) {
+    task(this->queue.Pop());
+  }
+}
+
+void SerialExecutor::Spawn(const TaskIndexList &ready) {
+  // spawned work goes before queued work of the same priority
+  this->_Queue(ready);
+}
+
+void SerialExecutor::_Queue(const TaskIndexList &ready) {
+  // queued last to first, so of equal priorities the first comes out first
+  for (auto it = ready.rbegin(); it != ready.rend(); it++) {
+    this->queue.Push(*it, (*this->priority)(*it));
+  }
+}
+
+std::string SerialExecutor::Name(void) { return "SERIAL"; }
+
+////////////////////////////////////////////////////////////////////////
+// persistent work stealing thread pool
+
+// the pool and worker the current thread belongs to, used by Spawn
+static thread_local PoolExecutor *current_pool = nullptr;
+static thread_local unsigned int current_worker = 0;
+
+PoolExecutor::PoolExecutor(unsigned int n_threads)
+    : workers(n_threads ? n_threads
+                        : std::max(1u, std::thread::hardware_concurrency())),
+      task(nullptr), priority(nullptr), n_pending(0), n_queued(0), n_idle(0),
+      generation(0), n_busy(0), shutdown(false) {
+  for (unsigned int wix = 1; wix < this->workers.size(); wix++) {
+    this->threads.push_back(std::thread(&PoolExecutor::_WorkerLoop, this, wix));
+  }
+}
+
+PoolExecutor::~PoolExecutor(void) {
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->shutdown = true;
+  }
+  this->start_cv.notify_all();
+  for (auto &t : this->threads) {
+    t.join();
+  }
+}
+
+void PoolExecutor::Run(const TaskIndexList &ready, const TaskFunction &task,
+                       const TaskPriority &priority) {
+  if (ready.empty()) {
+    return;
+  }
+  this->task = &task;
+  this->priority = &priority;
+  this->n_pending = ready.size();
+  this->n_queued = ready.size();
+  // deal the ready list out round robin, so every queue starts with its
+  // share of the most urgent work
+  auto n_workers = this->workers.size();
+  for (unsigned int ix = ready.size(); ix-- > 0;) {
+    Worker &w = this->workers[ix % n_workers];
+    std::lock_guard<std::mutex> lock(w.mutex);
+    w.tasks.Push(ready[ix], priority(ready[ix]));
+    w.n_tasks++;
+  }
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->generation++;
+  }
+  this->start_cv.notify_all();
+
+  // the calling thread is worker 0
+  current_pool = this;
+  current_worker = 0;
+  this->_Work(0);
+
+  // no pool thread may still hold the task when we return
+  std::unique_lock<std::mutex> lock(this->mutex);
+  this->done_cv.wait(lock, [this] { return this->n_busy == 0; });
+}
+
+void PoolExecutor::Spawn(const TaskIndexList &ready) {
+  if (ready.empty()) {
+    return;
+  }
+  // count the new tasks before the running one is retired, so n_pending
+  // can not drop to zero while work is still being added
+  this->n_pending += ready.size();
+  unsigned int wix = (current_pool == this) ? current_worker : 0;
+  this->_Push(wix, ready);
+  this->_Wake();
+}
+
+std::string PoolExecutor::Name(void) {
+  return "POOL(" + std::to_string(this->workers.size()) + ")";
+}
+
+void PoolExecutor::_WorkerLoop(unsigned int wix) {
+  current_pool = this;
+  current_worker = wix;
+  unsigned int seen = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(this->mutex);
+      this->start_cv.wait(lock, [this, &seen] {
+        return this->shutdown || this->generation != seen;
+      });
+      if (this->shutdown) {
+        return;
+      }
+      seen = this->generation;
+      this->n_busy++;
+    }
+    this->_Work(wix);
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->n_busy--;
+    }
+    this->done_cv.notify_all();
+  }
+}
+
+void PoolExecutor::_Work(unsigned int wix) {
+  // run tasks until every task of the run is done. A worker that finds
+  // nothing to take sleeps until tasks are queued or the run is over
+  unsigned int ix;
+  while (this->n_pending > 0) {
+    if (this->_Pop(wix, &ix)) {
+      (*this->task)(ix);
+      if (--this->n_pending == 0) {
+        this->_Wake();
+      }
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(this->mutex);
+    // n_idle is raised before n_queued is looked at, and _Wake raises
+    // n_queued before it looks at n_idle, so one of them sees the other
+    this->n_idle++;
+    this->work_cv.wait(lock, [this] {
+      return (this->n_queued > 0) || (this->n_pending == 0);
+    });
+    this->n_idle--;
+  }
+}
+
+void PoolExecutor::_Push(unsigned int wix, const TaskIndexList &ready) {
+  // queued last to first, so of equal priorities the first comes out first
+  Worker &w = this->workers[wix];
+  std::lock_guard<std::mutex> lock(w.mutex);
+  for (auto it = ready.rbegin(); it != ready.rend(); it++) {
+    w.tasks.Push(*it, (*this->priority)(*it));
+  }
+  w.n_tasks += ready.size();
+  this->n_queued += ready.size();
+}
+
+void PoolExecutor::_Wake(void) {
+  // wake the sleeping workers, if any. Taking the mutex orders the notify
+  // after a worker that is about to wait has checked its condition
+  if (this->n_idle == 0) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+  }
+  this->work_cv.notify_all();
+}
+
+bool PoolExecutor::_Pop(unsigned int wix, unsigned int *ix) {
+  // take the most urgent task of our own queue, else steal the most
+  // urgent task queued by any other worker. Empty queues are skipped
+  // without taking their mutex
+  if (this->n_queued == 0) {
+    return false;
+  }
+  auto n_workers = this->workers.size();
+  if (this->_Take(wix, ix)) {
+    return true;
+  }
+  unsigned int victim = wix;
+  unsigned int best = 0;
+  for (unsigned int k = 1; k < n_workers; k++) {
+    Worker &w = this->workers[(wix + k) % n_workers];
+    if (w.n_tasks == 0) {
+      continue;
+    }
+    std::lock_guard<std::mutex> lock(w.mutex);
+    unsigned int top;
+    if (w.tasks.Top(&top) && ((victim == wix) || (top > best))) {
+      victim = (wix + k) % n_workers;
+      best = top;
+    }
+  }
+  // the victim may have run its task since, then try again later
+  return (victim != wix) && this->_Take(victim, ix);
+}
+
+bool PoolExecutor::_Take(unsigned int wix, unsigned int *ix) {
+  // pop the most urgent task of queue wix, if it has one
+  Worker &w = this->workers[wix];
+  if (w.n_tasks == 0) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(w.mutex);
+  if (w.tasks.Empty()) {
+    return false;
+  }
+  *ix = w.tasks.Pop();
+  w.n_tasks--;
+  this->n_queued--;
+  return true;
+}
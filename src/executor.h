@@ -0,0 +1,169 @@
+// @file executor.h -- backends that run the gate tasks of a circuit
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other
+// contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+#ifndef SRC_EXECUTOR_H_
+#define SRC_EXECUTOR_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// the backends Circuit::Clock() can run its gates on
+//   OMP     an OpenMP parallel region per run, one omp task per gate
+//   POOL    a persistent pool of std::threads, each with its own queue of
+//           tasks, an idle worker steals from the other queues and sleeps
+//           when there is nothing to steal
+//   SERIAL  every gate is run inline on the calling thread
+enum class ExecutorEnum { OMP, POOL, SERIAL };
+
+using TaskIndexList = std::vector<unsigned int>;
+using TaskFunction = std::function<void(unsigned int)>;
+using TaskPriority = std::function<unsigned int(unsigned int)>;
+
+// An executor runs a task function on a list of indices (gates). While a
+// run is in progress a task may Spawn more indices, and Run returns when
+// every index, spawned ones included, has been processed. Lists passed to
+// Run and Spawn are in priority order, the first index is the most urgent,
+// and every backend looks up an index with priority to order its work.
+class Executor {
+public:
+  virtual ~Executor();
+  virtual void Run(const TaskIndexList &ready, const TaskFunction &task,
+                   const TaskPriority &priority) = 0;
+  virtual void Spawn(const TaskIndexList &ready) = 0;
+  virtual std::string Name(void) = 0;
+};
+
+// the queued tasks of a SERIAL executor or of one POOL worker. The most
+// urgent task is taken first, and among tasks of equal priority the one
+// queued last, so spawned work still runs depth first
+class TaskHeap {
+public:
+  TaskHeap();
+  void Push(unsigned int ix, unsigned int priority);
+  unsigned int Pop(void);
+  bool Top(unsigned int *priority) const;
+  bool Empty(void) const;
+  void Clear(void);
+
+private:
+  struct Entry {
+    unsigned int priority;
+    uint64_t seq; // order of the push
+    unsigned int ix;
+    bool operator<(const Entry &other) const;
+  };
+  std::vector<Entry> heap;
+  uint64_t seq;
+};
+
+class OmpExecutor : public Executor {
+public:
+  void Run(const TaskIndexList &ready, const TaskFunction &task,
+           const TaskPriority &priority);
+  void Spawn(const TaskIndexList &ready);
+  std::string Name(void);
+
+private:
+  void _Task(unsigned int);
+  const TaskFunction *task;
+  const TaskPriority *priority;
+};
+
+class SerialExecutor : public Executor {
+public:
+  void Run(const TaskIndexList &ready, const TaskFunction &task,
+           const TaskPriority &priority);
+  void Spawn(const TaskIndexList &ready);
+  std::string Name(void);
+
+private:
+  void _Queue(const TaskIndexList &ready);
+  TaskHeap queue;
+  const TaskPriority *priority;
+};
+
+class PoolExecutor : public Executor {
+public:
+  explicit PoolExecutor(unsigned int n_threads = 0); // 0 is one per core
+  ~PoolExecutor();
+  void Run(const TaskIndexList &ready, const TaskFunction &task,
+           const TaskPriority &priority);
+  void Spawn(const TaskIndexList &ready);
+  std::string Name(void);
+
+private:
+  // the owner and the thieves both take the most urgent task of a queue
+  struct Worker {
+    Worker() : n_tasks(0) {}
+    std::mutex mutex;
+    TaskHeap tasks;
+    std::atomic<unsigned int> n_tasks; // size of tasks, read without mutex
+  };
+  void _WorkerLoop(unsigned int);
+  void _Work(unsigned int);
+  bool _Pop(unsigned int, unsigned int *);
+  bool _Take(unsigned int, unsigned int *);
+  void _Push(unsigned int, const TaskIndexList &);
+  void _Wake(void);
+
+  std::vector<Worker> workers; // workers[0] is the thread calling Run
+  std::vector<std::thread> threads;
+  const TaskFunction *task;
+  const TaskPriority *priority;
+  std::atomic<unsigned int> n_pending; // tasks queued or running
+  std::atomic<unsigned int> n_queued;  // tasks queued, not yet taken
+  std::atomic<unsigned int> n_idle;    // workers waiting on work_cv
+
+  std::mutex mutex; // guards the fields below
+  std::condition_variable start_cv;
+  std::condition_variable done_cv;
+  std::condition_variable work_cv; // tasks were queued or the run ended
+  unsigned int generation; // bumped for every Run
+  unsigned int n_busy;     // pool threads inside the current Run
+  bool shutdown;
+};
+
+// n_threads sizes a POOL, 0 is one thread per core. OMP takes its threads
+// from the OpenMP runtime and SERIAL has none
+Executor *MakeExecutor(ExecutorEnum kind, unsigned int n_threads = 0);
+std::string ExecutorName(ExecutorEnum kind);
+
+#endif // SRC_EXECUTOR_H_
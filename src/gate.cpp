@@ -35,48 +35,393 @@
 #include "gate.h"
 
 #include <iostream>
+#include <memory>
 
-GateEvalParams::GateEvalParams(void) {}
+std::string GateOpName(GateEnum op) {
+  switch (op) {
+  case (GateEnum::INPUT):
+    return "INPUT";
+  case (GateEnum::OUTPUT):
+    return "OUTPUT";
+  case (GateEnum::NOT):
+    return "NOT";
+  case (GateEnum::AND):
+    return "AND";
+  case (GateEnum::OR):
+    return "OR";
+  case (GateEnum::XOR):
+    return "XOR";
+  case (GateEnum::DFF):
+    return "DFF";
+  case (GateEnum::LUT3):
+    return "LUT3";
+  case (GateEnum::LUT4):
+    return "LUT4";
+  case (GateEnum::AND3):
+    return "AND3";
+  case (GateEnum::OR3):
+    return "OR3";
+  case (GateEnum::AND4):
+    return "AND4";
+  case (GateEnum::OR4):
+    return "OR4";
+  case (GateEnum::MAJORITY):
+    return "MAJORITY";
+  case (GateEnum::CMUX):
+    return "CMUX";
+  default:
+    return "BAD";
+  }
+}
+
+std::string XorModeName(XorEnum xor_mode) {
+  switch (xor_mode) {
+  case (XorEnum::DECOMPOSED):
+    return "DECOMPOSED";
+  case (XorEnum::NATIVE):
+    return "NATIVE";
+  case (XorEnum::FAST):
+    return "FAST";
+  default:
+    return "BAD";
+  }
+}
+
+unsigned int GateBootstrapCost(GateEnum op, XorEnum xor_mode) {
+  // number of bootstraps Gate::Evaluate spends on an encrypted gate
+  switch (op) {
+  case (GateEnum::AND):
+  case (GateEnum::OR):
+    return 1;
+  case (GateEnum::XOR):
+    // decomposed into (a AND NOT b) OR (NOT a AND b), or a single gate
+    switch (xor_mode) {
+    case (XorEnum::NATIVE):
+    case (XorEnum::FAST):
+      return 1;
+    default:
+      return 3;
+    }
+  case (GateEnum::LUT3):
+  case (GateEnum::LUT4):
+  case (GateEnum::AND3):
+  case (GateEnum::OR3):
+  case (GateEnum::AND4):
+  case (GateEnum::OR4):
+  case (GateEnum::MAJORITY):
+    return 1;
+  case (GateEnum::CMUX):
+    return 3; // OpenFHE builds it from three NAND gates
+  default:
+    return 0; // NOT is a negation, the rest move wires
+  }
+}
+
+unsigned int GateInputCount(GateEnum op) {
+  // number of inputs a gate of type op has
+  switch (op) {
+  case (GateEnum::INPUT):
+    return 0;
+  case (GateEnum::OUTPUT):
+  case (GateEnum::NOT):
+  case (GateEnum::DFF):
+    return 1;
+  case (GateEnum::AND):
+  case (GateEnum::OR):
+  case (GateEnum::XOR):
+    return 2;
+  case (GateEnum::LUT3):
+  case (GateEnum::AND3):
+  case (GateEnum::OR3):
+  case (GateEnum::MAJORITY):
+  case (GateEnum::CMUX):
+    return 3;
+  case (GateEnum::LUT4):
+  case (GateEnum::AND4):
+  case (GateEnum::OR4):
+    return 4;
+  default:
+    return 0;
+  }
+}
+
+std::string EncodingName(const Encoding &encoding) {
+  switch (encoding.kind) {
+  case (EncodingEnum::BOOLEAN):
+    return "BOOLEAN";
+  case (EncodingEnum::MULTI_INPUT):
+    return "MULTI_INPUT" + std::to_string(encoding.fan_in);
+  case (EncodingEnum::FUNCTIONAL):
+    return "FUNCTIONAL" + std::to_string(encoding.fan_in);
+  default:
+    return "BAD";
+  }
+}
+
+lbcrypto::LWEPlaintextModulus PlaintextModulus(const Encoding &encoding) {
+  // plaintext modulus the bits are encrypted with
+  switch (encoding.kind) {
+  case (EncodingEnum::MULTI_INPUT):
+    return 2 * encoding.fan_in;
+  case (EncodingEnum::FUNCTIONAL):
+    return lbcrypto::LWEPlaintextModulus(1) << (encoding.fan_in + 1);
+  default:
+    return 4;
+  }
+}
+
+Encoding::Encoding(EncodingEnum kind, unsigned int fan_in)
+    : kind(kind), fan_in(fan_in) {}
+
+GateEvalParams::GateEvalParams(void)
+    : xor_mode(XorEnum::DECOMPOSED), luts(nullptr), mismatches(nullptr) {}
+
+static void count_mismatch(const GateEvalParams &gep, GateEnum op) {
+  // a verified gate did not match its plaintext, count it by opcode
+  if (gep.mismatches) {
+#pragma omp atomic
+    gep.mismatches[static_cast<unsigned int>(op)]++;
+  }
+}
 
 GateEvalParams::~GateEvalParams(void) {}
 
-Gate::Gate(void) {}
+Gate::Gate(void) : id(0), bus(0), bit(0), table(0) {}
 
 Gate::~Gate(void) {}
 
-void Gate::Reset(void) {}
+std::string Gate::Name(void) const {
+  // built when asked for, so loading a circuit makes no strings
+  return GateOpName(this->op) + ":" + std::to_string(this->id);
+}
 
-void Gate::Evaluate(const GateEvalParams &gep) {
-  OPENFHE_DEBUG_FLAG(false);
-  OPENFHE_DEBUG("in evaluate for gate " << this->name);
+bool Gate::TruthTable(unsigned int *out) const {
+  // the truth table of a gate that bootstraps, the output for inputs
+  // in0 + 2 in1 + 4 in2 (+ 8 in3) is that bit. False for the others
+  switch (this->op) {
+  case (GateEnum::AND):
+    *out = 0x8;
+    break;
+  case (GateEnum::OR):
+    *out = 0xE;
+    break;
+  case (GateEnum::XOR):
+    *out = 0x6;
+    break;
+  case (GateEnum::LUT3):
+  case (GateEnum::LUT4):
+    *out = this->table;
+    break;
+  case (GateEnum::AND3):
+    *out = 0x80;
+    break;
+  case (GateEnum::OR3):
+    *out = 0xFE;
+    break;
+  case (GateEnum::AND4):
+    *out = 0x8000;
+    break;
+  case (GateEnum::OR4):
+    *out = 0xFFFE;
+    break;
+  case (GateEnum::MAJORITY):
+    *out = 0xE8;
+    break;
+  case (GateEnum::CMUX):
+    *out = 0xCA;
+    break;
+  default:
+    return false;
+  }
+  return true;
+}
 
-  bool all_ready(true);
+static lbcrypto::LWEPlaintext decrypt(const GateEvalParams &gep,
+                                      const CipherText &ct) {
+  lbcrypto::LWEPlaintext res;
+  gep.cc.Decrypt(gep.sk, ct, &res, PlaintextModulus(gep.encoding));
+  return res;
+}
 
-  auto plaintext_flag = gep.plaintext_flag;
-  auto encrypted_flag = gep.encrypted_flag;
-  auto verify_flag = gep.verify_flag;
+static CipherText encrypt(const GateEvalParams &gep, unsigned int value) {
+  return gep.cc.Encrypt(gep.sk, value, lbcrypto::BOOTSTRAPPED,
+                        PlaintextModulus(gep.encoding));
+}
+
+static CipherText eval_not(const GateEvalParams &gep, const CipherText &in) {
+  // EvalNOT computes q/4 - in, which only negates a bit encrypted with a
+  // plaintext modulus of 4. Other encodings compute q/p - in with the LWE
+  // scheme, neither needs a bootstrap
+  auto p = PlaintextModulus(gep.encoding);
+  if (p == 4) {
+    return gep.cc.EvalNOT(in);
+  }
+  auto out = std::make_shared<lbcrypto::LWECiphertextImpl>(*in);
+  uint64_t q = out->GetModulus().ConvertToInt();
+  gep.scheme->EvalMultConstEq(out, lbcrypto::NativeInteger(q - 1));
+  gep.scheme->EvalAddConstEq(out, lbcrypto::NativeInteger(q / p));
+  return out;
+}
+
+static CipherText eval_constant(const GateEvalParams &gep,
+                                const CipherText &like, unsigned int value) {
+  // a noiseless encryption of value with the modulus and dimension of
+  // like, which needs no secret key
+  auto out = std::make_shared<lbcrypto::LWECiphertextImpl>(*like);
+  uint64_t q = out->GetModulus().ConvertToInt();
+  gep.scheme->EvalMultConstEq(out, lbcrypto::NativeInteger(0));
+  if (value) {
+    uint64_t p = PlaintextModulus(gep.encoding);
+    gep.scheme->EvalAddConstEq(out, lbcrypto::NativeInteger(q / p));
+  }
+  return out;
+}
+
+static CipherText eval_threshold(const GateEvalParams &gep, bool is_and,
+                                 const CipherTextList &in) {
+  // AND or OR of up to fan_in inputs with one bootstrap of the fan_in
+  // input gate, the missing inputs are constants that do not change it
+  auto fan_in = gep.encoding.fan_in;
+  CipherTextList padded(in);
+  while (padded.size() < fan_in) {
+    padded.push_back(eval_constant(gep, in[0], is_and));
+  }
+  lbcrypto::BINGATE gate;
+  if (fan_in == 3) {
+    gate = is_and ? lbcrypto::AND3 : lbcrypto::OR3;
+  } else {
+    gate = is_and ? lbcrypto::AND4 : lbcrypto::OR4;
+  }
+  return gep.cc.EvalBinGate(gate, padded);
+}
+
+static CipherText eval_multi_input(const GateEvalParams &gep, GateEnum op,
+                                   const CipherTextList &in) {
+  // a gate in the MULTI_INPUT encoding, the two input gates of OpenFHE
+  // only take a plaintext modulus of 4
+  switch (op) {
+  case (GateEnum::AND):
+  case (GateEnum::AND3):
+  case (GateEnum::AND4):
+    return eval_threshold(gep, true, in);
+  case (GateEnum::OR):
+  case (GateEnum::OR3):
+  case (GateEnum::OR4):
+    return eval_threshold(gep, false, in);
+  case (GateEnum::XOR): {
+    // (a AND NOT b) OR (NOT a AND b)
+    auto tmp1 = eval_threshold(gep, true, {in[0], eval_not(gep, in[1])});
+    auto tmp2 = eval_threshold(gep, true, {eval_not(gep, in[0]), in[1]});
+    return eval_threshold(gep, false, {tmp1, tmp2});
+  }
+  case (GateEnum::MAJORITY):
+    if (gep.encoding.fan_in == 3) {
+      return gep.cc.EvalBinGate(lbcrypto::MAJORITY, in);
+    }
+    break;
+  case (GateEnum::CMUX): {
+    // (in0 AND NOT sel) OR (in1 AND sel), three bootstraps as in OpenFHE
+    auto tmp1 = eval_threshold(gep, true, {in[0], eval_not(gep, in[2])});
+    auto tmp2 = eval_threshold(gep, true, {in[1], in[2]});
+    return eval_threshold(gep, false, {tmp1, tmp2});
+  }
+  default:
+    break;
+  }
+  std::cerr << "Error no " << GateOpName(op) << " gate in the "
+            << EncodingName(gep.encoding) << " encoding" << std::endl;
+  exit(-1);
+}
+
+static CipherText eval_table(const GateEvalParams &gep, unsigned int table,
+                             const CipherTextList &in) {
+  // evaluate a truth table on encrypted bits with one functional
+  // bootstrap. The index in0 + 2 in1 + 4 in2 (+ 8 in3) is a weighted sum
+  // of the inputs, which needs no bootstrap, and EvalFunc maps it through
+  // the lookup table the evaluation state built for the truth table
+  auto lut = gep.luts ? gep.luts->find(table) : LutMap::const_iterator();
+  if (!gep.luts || (lut == gep.luts->end())) {
+    std::cerr << "Error no lookup table for truth table " << table
+              << ", the keys are not made for the FUNCTIONAL encoding"
+              << std::endl;
+    exit(-1);
+  }
+  auto index = std::make_shared<lbcrypto::LWECiphertextImpl>(*in[0]);
+  for (unsigned int ix = 1; ix < in.size(); ix++) {
+    auto term = std::make_shared<lbcrypto::LWECiphertextImpl>(*in[ix]);
+    gep.scheme->EvalMultConstEq(term, lbcrypto::NativeInteger(1u << ix));
+    gep.scheme->EvalAddEq(index, term);
+  }
+  return gep.cc.EvalFunc(index, lut->second);
+}
 
-  for (auto it : this->ready) {
-    all_ready &= it;
+static bool evaluate_table(const Gate &g, const GateEvalParams &gep,
+                           unsigned int table, const BitList &plainin,
+                           const CipherTextList &encin, BitList *plainout,
+                           CipherTextList *encout) {
+  // a gate of more than two inputs, or any gate with a truth table in an
+  // encoding other than BOOLEAN
+  if (gep.plaintext_flag) {
+    unsigned int ix = 0;
+    for (unsigned int bit = 0; bit < plainin.size(); bit++) {
+      ix |= (plainin[bit] & 1) << bit;
+    }
+    plainout->resize(1);
+    (*plainout)[0] = (table >> ix) & 1;
   }
-  if (!all_ready) {
-    std::cerr << "error, executing gate " << this->name
-              << " but inputs not ready!" << std::endl;
+
+  if (gep.encrypted_flag) {
+    encout->resize(1);
+    if (gep.encoding.kind == EncodingEnum::MULTI_INPUT) {
+      (*encout)[0] = eval_multi_input(gep, g.op, encin);
+    } else {
+      (*encout)[0] = eval_table(gep, table, encin);
+    }
+
+    if (gep.verify_flag) {
+      if (decrypt(gep, (*encout)[0]) != (*plainout)[0]) {
+        std::cerr << "Bad " << GateOpName(g.op) << " fixing" << std::endl;
+        count_mismatch(gep, g.op);
+        (*encout)[0] = encrypt(gep, (*plainout)[0]);
+      }
+    }
   }
-  OPENFHE_DEBUGEXP(this->encin.size());
+  return true;
+}
+
+bool Gate::Evaluate(const GateEvalParams &gep, const BitList &plainin,
+                    const CipherTextList &encin, BitList *plainout,
+                    CipherTextList *encout) const {
+  OPENFHE_DEBUG_FLAG(false);
+  OPENFHE_DEBUG("in evaluate for gate " << this->Name());
+
+  auto plaintext_flag = gep.plaintext_flag;
+  auto encrypted_flag = gep.encrypted_flag;
+  auto verify_flag = gep.verify_flag;
+  OPENFHE_DEBUGEXP(encin.size());
   OPENFHE_DEBUGEXP(plaintext_flag);
   OPENFHE_DEBUGEXP(encrypted_flag);
-  if (encrypted_flag) {
-    OPENFHE_DEBUGEXP(this->encin[0]);
-    lbcrypto::LWEPlaintext res;
-    gep.cc.Decrypt(gep.sk, this->encin[0], &res);
-    OPENFHE_DEBUGEXP(res);
-    if (this->encin.size() > 1) {
-      gep.cc.Decrypt(gep.sk, this->encin[1], &res);
-      OPENFHE_DEBUGEXP(res);
+  if (encrypted_flag && verify_flag) { // only a verifier holds the sk
+    OPENFHE_DEBUGEXP(encin[0]);
+    OPENFHE_DEBUGEXP(decrypt(gep, encin[0]));
+    if (encin.size() > 1) {
+      OPENFHE_DEBUGEXP(decrypt(gep, encin[1]));
     }
   }
-  OPENFHE_DEBUGEXP(this->name);
+  OPENFHE_DEBUGEXP(this->Name());
+
+  // the gates of more than two inputs (but CMUX) need an encoding other
+  // than BOOLEAN, which evaluates every gate with a truth table its own
+  // way. Their plaintext is computed from the table
+  unsigned int table;
+  bool boolean_gate =
+      (GateInputCount(this->op) <= 2) || (this->op == GateEnum::CMUX);
+  bool encoded =
+      encrypted_flag && (gep.encoding.kind != EncodingEnum::BOOLEAN);
+  if ((!boolean_gate || encoded) && this->TruthTable(&table)) {
+    return evaluate_table(*this, gep, table, plainin, encin, plainout,
+                          encout);
+  }
 
   switch (this->op) {
   case (GateEnum::INPUT):
@@ -84,99 +429,99 @@ void Gate::Evaluate(const GateEvalParams &gep) {
     break;
   case (GateEnum::OUTPUT):
     if (plaintext_flag) {
-      plainout.resize(1);
-      plainout[0] = this->plainin[0]; // copy input
+      plainout->resize(1);
+      (*plainout)[0] = plainin[0]; // copy input
     }
     if (encrypted_flag) {
       // lbcrypto::LWEPlaintext res;
 
-      encout.resize(1);
-      encout[0] = encin[0];
+      encout->resize(1);
+      (*encout)[0] = encin[0];
       if (verify_flag) {
-        lbcrypto::LWEPlaintext res;
-        gep.cc.Decrypt(gep.sk, this->encin[0], &res);
-        unsigned int out = (unsigned int)res;
-        if (out != plainout[0]) {
+        unsigned int out = (unsigned int)decrypt(gep, encin[0]);
+        if (out != (*plainout)[0]) {
           std::cerr << "Bad OUTPUT fixing" << std::endl;
+          count_mismatch(gep, GateEnum::OUTPUT);
         }
       }
     }
     break;
   case (GateEnum::NOT):
     if (plaintext_flag) {
-      plainout.resize(1);
-      plainout[0] = !this->plainin[0];
+      plainout->resize(1);
+      (*plainout)[0] = !plainin[0];
     }
     if (encrypted_flag) {
-      encout.resize(1);
-      encout[0] = gep.cc.EvalNOT(this->encin[0]);
+      encout->resize(1);
+      (*encout)[0] = eval_not(gep, encin[0]);
       if (verify_flag) {
-        lbcrypto::LWEPlaintext res;
-        gep.cc.Decrypt(gep.sk, encout[0], &res);
-        if (res != plainout[0]) {
+        if (decrypt(gep, (*encout)[0]) != (*plainout)[0]) {
           std::cerr << "Bad NOT fixing" << std::endl;
-          encout[0] = gep.cc.Encrypt(gep.sk, plainout[0]);
+          count_mismatch(gep, GateEnum::NOT);
+          (*encout)[0] = encrypt(gep, (*plainout)[0]);
         }
       }
     }
     break;
   case (GateEnum::AND):
     if (plaintext_flag) {
-      plainout.resize(1);
-      plainout[0] = this->plainin[0] && this->plainin[1];
+      plainout->resize(1);
+      (*plainout)[0] = plainin[0] && plainin[1];
     }
 
     if (encrypted_flag) {
-      encout.resize(1);
+      encout->resize(1);
       try {
-        encout[0] =
-            gep.cc.EvalBinGate(lbcrypto::AND, this->encin[0], this->encin[1]);
+        (*encout)[0] = gep.cc.EvalBinGate(lbcrypto::AND, encin[0], encin[1]);
       } catch (...) {
-        std::cerr << "throw!! executing gate RETRY " << this->name << std::endl;
-        lbcrypto::LWEPlaintext res;
-        gep.cc.Decrypt(gep.sk, this->encin[0], &res);
+        if (!gep.sk) {
+          // no secret key to repair the inputs with, report the failure
+          std::cerr << "throw!! executing gate FAILED " << this->Name()
+                    << std::endl;
+          (*encout)[0] = CipherText();
+          return false;
+        }
+        std::cerr << "throw!! executing gate RETRY " << this->Name() << std::endl;
+        // retry on fresh encryptions of the inputs
+        auto res = decrypt(gep, encin[0]);
         std::cerr << "in[0] " << res << std::endl;
-        this->encin[0] = gep.cc.Encrypt(gep.sk, res);
+        auto in0 = encrypt(gep, res);
 
-        gep.cc.Decrypt(gep.sk, this->encin[1], &res);
+        res = decrypt(gep, encin[1]);
         std::cerr << "in[1] " << res << std::endl;
-        this->encin[1] = gep.cc.Encrypt(gep.sk, res);
+        auto in1 = encrypt(gep, res);
         try {
-          encout[0] =
-              gep.cc.EvalBinGate(lbcrypto::AND, this->encin[0], this->encin[1]);
+          (*encout)[0] = gep.cc.EvalBinGate(lbcrypto::AND, in0, in1);
         } catch (...) {
-          std::cerr << "FAILED rethrow!! executing gate RETRY " << this->name
+          std::cerr << "FAILED rethrow!! executing gate RETRY " << this->Name()
                     << std::endl;
           exit(-1);
         }
       }
       if (verify_flag) {
-        lbcrypto::LWEPlaintext res;
-        gep.cc.Decrypt(gep.sk, encout[0], &res);
-        if (res != plainout[0]) {
+        if (decrypt(gep, (*encout)[0]) != (*plainout)[0]) {
           std::cerr << "Bad AND fixing" << std::endl;
-          encout[0] = gep.cc.Encrypt(gep.sk, plainout[0]);
+          count_mismatch(gep, GateEnum::AND);
+          (*encout)[0] = encrypt(gep, (*plainout)[0]);
         }
       }
     }
     break;
   case (GateEnum::OR):
     if (plaintext_flag) {
-      plainout.resize(1);
-      plainout[0] = this->plainin[0] || this->plainin[1];
+      plainout->resize(1);
+      (*plainout)[0] = plainin[0] || plainin[1];
     }
 
     if (encrypted_flag) {
-      encout.resize(1);
-      encout[0] =
-          gep.cc.EvalBinGate(lbcrypto::OR, this->encin[0], this->encin[1]);
+      encout->resize(1);
+      (*encout)[0] = gep.cc.EvalBinGate(lbcrypto::OR, encin[0], encin[1]);
 
       if (verify_flag) {
-        lbcrypto::LWEPlaintext res;
-        gep.cc.Decrypt(gep.sk, encout[0], &res);
-        if (res != plainout[0]) {
+        if (decrypt(gep, (*encout)[0]) != (*plainout)[0]) {
           std::cerr << "Bad OR fixing" << std::endl;
-          encout[0] = gep.cc.Encrypt(gep.sk, plainout[0]);
+          count_mismatch(gep, GateEnum::OR);
+          (*encout)[0] = encrypt(gep, (*plainout)[0]);
         }
       }
     }
@@ -184,46 +529,71 @@ void Gate::Evaluate(const GateEvalParams &gep) {
     break;
   case (GateEnum::XOR):
     if (plaintext_flag) {
-      plainout.resize(1);
-      plainout[0] = this->plainin[0] ^ this->plainin[1];
-      OPENFHE_DEBUGEXP(plainout[0]);
+      plainout->resize(1);
+      (*plainout)[0] = plainin[0] ^ plainin[1];
+      OPENFHE_DEBUGEXP((*plainout)[0]);
     }
 
     if (encrypted_flag) {
-      encout.resize(1);
-#if 0 // current XOR has a higher failure rate, replace with equivalent gates
-	  auto foo = gep.cc.EvalBinGate(lbcrypto::XOR, this->encin[0], this->encin[1]);
-#else
-      // avoid xor for now
-      auto notin0 = gep.cc.EvalNOT(this->encin[0]);
-      auto notin1 = gep.cc.EvalNOT(this->encin[1]);
-      auto tmp1 = gep.cc.EvalBinGate(lbcrypto::AND, this->encin[0], notin1);
-      auto tmp2 = gep.cc.EvalBinGate(lbcrypto::AND, notin0, this->encin[1]);
-      auto foo = gep.cc.EvalBinGate(lbcrypto::OR, tmp1, tmp2);
-#endif
-      encout[0] = foo;
-      OPENFHE_DEBUGEXP(encout[0]);
+      encout->resize(1);
+      if (gep.xor_mode == XorEnum::NATIVE) {
+        (*encout)[0] = gep.cc.EvalBinGate(lbcrypto::XOR, encin[0], encin[1]);
+      } else if (gep.xor_mode == XorEnum::FAST) {
+        (*encout)[0] =
+            gep.cc.EvalBinGate(lbcrypto::XOR_FAST, encin[0], encin[1]);
+      } else {
+        // native xor has a higher failure rate on some parameter sets,
+        // replace it with equivalent gates
+        auto notin0 = eval_not(gep, encin[0]);
+        auto notin1 = eval_not(gep, encin[1]);
+        auto tmp1 = gep.cc.EvalBinGate(lbcrypto::AND, encin[0], notin1);
+        auto tmp2 = gep.cc.EvalBinGate(lbcrypto::AND, notin0, encin[1]);
+        (*encout)[0] = gep.cc.EvalBinGate(lbcrypto::OR, tmp1, tmp2);
+      }
+      OPENFHE_DEBUGEXP((*encout)[0]);
       if (verify_flag) {
-        lbcrypto::LWEPlaintext res;
-        gep.cc.Decrypt(gep.sk, encout[0], &res);
-        if (res != plainout[0]) {
+        if (decrypt(gep, (*encout)[0]) != (*plainout)[0]) {
           std::cerr << "Bad XOR fixing" << std::endl;
-          encout[0] = gep.cc.Encrypt(gep.sk, plainout[0]);
+          count_mismatch(gep, GateEnum::XOR);
+          (*encout)[0] = encrypt(gep, (*plainout)[0]);
         }
       }
     }
 
     break;
   case (GateEnum::DFF):
-    std::cerr << "remember to write DFF" << std::endl;
-    break;
-  case (GateEnum::LUT3):
-    std::cerr << "remember to write LUT3" << std::endl;
+    // pass the input through, the caller latches it for the next cycle
+    if (plaintext_flag) {
+      plainout->resize(1);
+      (*plainout)[0] = plainin[0];
+    }
+    if (encrypted_flag) {
+      encout->resize(1);
+      (*encout)[0] = encin[0];
+    }
     break;
-  case (GateEnum::LUT4):
-    std::cerr << "remember to write LUT4" << std::endl;
+  case (GateEnum::CMUX):
+    if (plaintext_flag) {
+      plainout->resize(1);
+      (*plainout)[0] = plainin[2] ? plainin[1] : plainin[0];
+    }
+
+    if (encrypted_flag) {
+      encout->resize(1);
+      (*encout)[0] = gep.cc.EvalBinGate(lbcrypto::CMUX, encin);
+      OPENFHE_DEBUGEXP((*encout)[0]);
+
+      if (verify_flag) {
+        if (decrypt(gep, (*encout)[0]) != (*plainout)[0]) {
+          std::cerr << "Bad CMUX fixing" << std::endl;
+          count_mismatch(gep, GateEnum::CMUX);
+          (*encout)[0] = encrypt(gep, (*plainout)[0]);
+        }
+      }
+    }
     break;
   default:
     std::cerr << "bad gate eval" << std::endl;
   }
+  return true;
 }
@@ -40,15 +40,73 @@
 #include <algorithm>
 #include <deque>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
-// using ReadyList = std::map<std::string, bool>;
-using ReadyList = std::vector<bool>;
 using CipherTextList = std::vector<CipherText>;
 using BitList = std::vector<unsigned int>;
 
-enum class GateEnum { INPUT, OUTPUT, NOT, AND, OR, XOR, DFF, LUT3, LUT4 };
+// note these values are stored in compiled circuit files, only append
+// AND3/OR3/AND4/OR4 are 3 and 4 input AND and OR gates, MAJORITY is 1 if
+// two of its three inputs are, CMUX(in0, in1, sel) is sel ? in1 : in0
+enum class GateEnum {
+  INPUT,
+  OUTPUT,
+  NOT,
+  AND,
+  OR,
+  XOR,
+  DFF,
+  LUT3,
+  LUT4,
+  AND3,
+  OR3,
+  AND4,
+  OR4,
+  MAJORITY,
+  CMUX
+};
+const unsigned int N_GATE_OPS = static_cast<unsigned int>(GateEnum::CMUX) + 1;
+
+// how an encrypted XOR is computed
+//   DECOMPOSED (a AND NOT b) OR (NOT a AND b), three bootstraps but the
+//              lowest failure rate
+//   NATIVE     EvalBinGate(XOR), one bootstrap
+//   FAST       EvalBinGate(XOR_FAST), one bootstrap of the difference of
+//              the inputs
+enum class XorEnum { DECOMPOSED, NATIVE, FAST };
+const unsigned int N_XOR_MODES = static_cast<unsigned int>(XorEnum::FAST) + 1;
+
+// how the bits of an encrypted evaluation are encoded, the keys must be
+// made for the encoding the gates of the circuit need
+//   BOOLEAN     plaintext modulus 4, gates of up to two inputs (and CMUX)
+//   MULTI_INPUT plaintext modulus 2 fan_in in an STD128_3 or STD128_4
+//               context. Every gate that bootstraps is built from the
+//               fan_in input AND and OR gates, with constant inputs
+//               padding the gates of fewer inputs, and MAJORITY for a
+//               fan_in of 3. Needed by AND3/OR3, AND4/OR4 and MAJORITY
+//   FUNCTIONAL  plaintext modulus 2^(fan_in + 1) in a context made for
+//               arbitrary functions. Every gate with a truth table is a
+//               lookup on the weighted sum of its inputs, so gates of up
+//               to fan_in inputs (LUT3/LUT4 ...) can be evaluated. The top
+//               bit is the padding functional bootstrapping needs
+enum class EncodingEnum { BOOLEAN, MULTI_INPUT, FUNCTIONAL };
+
+struct Encoding {
+  Encoding(EncodingEnum kind = EncodingEnum::BOOLEAN,
+           unsigned int fan_in = 2);
+  bool operator==(const Encoding &other) const {
+    return (kind == other.kind) && (fan_in == other.fan_in);
+  }
+  bool operator!=(const Encoding &other) const { return !(*this == other); }
+  EncodingEnum kind;
+  unsigned int fan_in; // most inputs of a gate
+};
+
+// lookup tables of EvalFunc, by the truth table they compute
+using LutTable = std::vector<lbcrypto::NativeInteger>;
+using LutMap = std::map<unsigned int, LutTable>;
 
 class GateEvalParams {
 public:
@@ -58,25 +116,54 @@ public:
   bool encrypted_flag;
   bool verify_flag;
 
-  lbcrypto::BinFHEContext cc;
-  lbcrypto::LWEPrivateKey sk;
+  XorEnum xor_mode;
+
+  lbcrypto::BinFHEContext cc; // holds the bootstrapping keys
+  lbcrypto::LWEPrivateKey sk; // null on a keyless evaluator
+  // negation and weighted sums of ciphertexts, which need no bootstrap
+  std::shared_ptr<lbcrypto::LWEEncryptionScheme> scheme;
+
+  Encoding encoding;
+  const LutMap *luts; // FUNCTIONAL encoding, the tables of the circuit
+
+  // if set, verify mode counts the encrypted outputs that did not match
+  // the plaintext ones in mismatches[op], N_GATE_OPS entries
+  unsigned int *mismatches;
 };
 
+// a gate of the netlist. Gates are not changed by evaluation, the values
+// on their wires are held by the caller, so one gate can be evaluated by
+// several threads at once. Evaluate returns false if the encrypted gate
+// could not be computed and there was no secret key to repair it with
 class Gate {
 public:
   Gate();
   ~Gate();
-  void Reset(void);
-  void Evaluate(const GateEvalParams &);
-  std::string name; // note can be an integer
+  bool Evaluate(const GateEvalParams &, const BitList &plainin,
+                const CipherTextList &encin, BitList *plainout,
+                CipherTextList *encout) const;
+  bool TruthTable(unsigned int *table) const;
+  std::string Name(void) const;
+  unsigned int id; // number of the gate in the listing, it is named OP:id
   GateEnum op;
-  NameList inWireNames;
-  ReadyList ready;
-  NameList outWireNames;
-  CipherTextList encin;
-  BitList plainin;
-  CipherTextList encout;
-  BitList plainout;
+  NameList inWireNames;  // register names of the wires of a text listing,
+  NameList outWireNames; // gates loaded from a compiled circuit have none
+  WireIdList inWires;  // integer ids of inWireNames (not used by INPUT)
+  WireIdList outWires; // integer ids of outWireNames (not used by OUTPUT)
+                       // a DFF drives its wire in the next cycle
+  unsigned int bus;    // INPUT/OUTPUT gates: the input or output bus and
+  unsigned int bit;    // the bit of it the gate loads or stores
+  unsigned int table;  // LUT3/LUT4 truth table, the output for inputs
+                       // in0 + 2 in1 + 4 in2 (+ 8 in3) is that bit
 };
 
+// function declaration
+std::string GateOpName(GateEnum op);
+unsigned int GateBootstrapCost(GateEnum op,
+                               XorEnum xor_mode = XorEnum::DECOMPOSED);
+std::string XorModeName(XorEnum xor_mode);
+unsigned int GateInputCount(GateEnum op);
+std::string EncodingName(const Encoding &encoding);
+lbcrypto::LWEPlaintextModulus PlaintextModulus(const Encoding &encoding);
+
 #endif
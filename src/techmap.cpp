@@ -0,0 +1,581 @@
+// @file techmap.cpp -- technology mapping passes over a compiled circuit
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other
+// contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+#include "techmap.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <unordered_map>
+
+#include "cktfile.h"
+#include "utils.h"
+
+static const unsigned int NO_DRIVER = UINT_MAX;
+static const unsigned int MAX_LUT_IN = 4;
+static const unsigned int MAX_FUSE_IN = 4;
+static const unsigned int MAX_MATCH_GATES = 6; // largest cone matched
+static const unsigned int MAJORITY_TABLE = 0xE8;
+
+unsigned int CountBootstraps(const CompiledCircuit &ckt, XorEnum xor_mode) {
+  unsigned int n_boot = 0;
+  for (auto const &g : ckt.allGates) {
+    n_boot += GateBootstrapCost(g.op, xor_mode);
+  }
+  return n_boot;
+}
+
+static bool is_mappable(GateEnum op) {
+  return (op == GateEnum::NOT) || (op == GateEnum::AND) ||
+         (op == GateEnum::OR) || (op == GateEnum::XOR);
+}
+
+static bool is_lut(GateEnum op) {
+  return (op == GateEnum::LUT3) || (op == GateEnum::LUT4);
+}
+
+// the gate a pass puts in place of the root of a cone, in is empty for
+// gates that are kept as they are
+struct Replacement {
+  GateEnum op;
+  GateIndexList in;
+  unsigned int table;
+};
+
+// the circuit in program order with the absorbed gates dropped and the
+// roots of the cones replaced
+static std::shared_ptr<CompiledCircuit>
+rebuild(const CompiledCircuit &ckt, const std::vector<bool> &absorbed,
+        const std::vector<Replacement> &replaced) {
+  CktFile mapped;
+  for (auto const &g : ckt.inputGates) {
+    mapped.AddInput(g.bus, g.bit, g.outWires[0]);
+  }
+  for (unsigned int gix = 0; gix < ckt.allGates.size(); gix++) {
+    auto const &g = ckt.allGates[gix];
+    auto const &rep = replaced[gix];
+    if (absorbed[gix]) {
+      continue;
+    }
+    if (!rep.in.empty()) {
+      if (is_lut(rep.op)) {
+        mapped.AddLut(rep.op, rep.in, rep.table, g.outWires[0]);
+      } else {
+        mapped.AddGate(rep.op, rep.in, g.outWires[0]);
+      }
+    } else if (g.op == GateEnum::OUTPUT) {
+      mapped.AddOutput(g.bus, g.bit, g.inWires[0]);
+    } else if (is_lut(g.op)) {
+      mapped.AddLut(g.op, g.inWires, g.table, g.outWires[0]);
+    } else {
+      mapped.AddGate(g.op, g.inWires, g.outWires[0]);
+    }
+  }
+  mapped.n_wires = ckt.n_wires;
+  mapped.GenerateFanout();
+
+  auto compiled = std::make_shared<CompiledCircuit>();
+  if (!compiled->LoadCkt(mapped.View())) {
+    return nullptr;
+  }
+  return compiled;
+}
+
+// the gate driving each wire, NO_DRIVER for wires driven by the inputs
+// or by a DFF
+static GateIndexList find_drivers(const CompiledCircuit &ckt) {
+  GateIndexList driver(ckt.n_wires, NO_DRIVER);
+  for (unsigned int gix = 0; gix < ckt.allGates.size(); gix++) {
+    auto const &g = ckt.allGates[gix];
+    if (g.op != GateEnum::DFF) {
+      for (auto wid : g.outWires) {
+        driver[wid] = gix;
+      }
+    }
+  }
+  return driver;
+}
+
+// value of a wire of a cone, given the values of its leaf wires
+static unsigned int
+eval_cone(const CompiledCircuit &ckt, const GateIndexList &driver,
+          const std::unordered_map<unsigned int, unsigned int> &leafValue,
+          unsigned int wid) {
+  auto it = leafValue.find(wid);
+  if (it != leafValue.end()) {
+    return it->second;
+  }
+  auto const &g = ckt.allGates[driver[wid]];
+  unsigned int a = eval_cone(ckt, driver, leafValue, g.inWires[0]);
+  if (g.op == GateEnum::NOT) {
+    return !a;
+  }
+  unsigned int b = eval_cone(ckt, driver, leafValue, g.inWires[1]);
+  switch (g.op) {
+  case (GateEnum::AND):
+    return a && b;
+  case (GateEnum::OR):
+    return a || b;
+  default:
+    return a ^ b;
+  }
+}
+
+std::shared_ptr<const CompiledCircuit> MapLuts(const CompiledCircuit &ckt,
+                                               XorEnum xor_mode) {
+  // grow a cone back from every gate, outputs first, by absorbing the
+  // driver of one of its leaf wires as long as the wire has no other
+  // reader and the cone keeps at most four leaves. Gates absorbed into a
+  // mapped cone are dropped, the root becomes a LUT of the cone
+  TIC(auto t_map);
+  auto driver = find_drivers(ckt);
+  auto const &fanoutStart = ckt.fanoutStart;
+  std::vector<bool> absorbed(ckt.allGates.size(), false);
+  std::vector<Replacement> replaced(ckt.allGates.size());
+  unsigned int n_luts = 0;
+  unsigned int n_packed = 0;
+  for (auto it = ckt.levelGates.rbegin(); it != ckt.levelGates.rend(); it++) {
+    unsigned int root = *it;
+    auto const &r = ckt.allGates[root];
+    if (absorbed[root] || !is_mappable(r.op)) {
+      continue;
+    }
+    GateIndexList cone(1, root);
+    GateIndexList leaves;
+    for (auto iw : r.inWires) {
+      if (std::find(leaves.begin(), leaves.end(), iw) == leaves.end()) {
+        leaves.push_back(iw);
+      }
+    }
+    bool grown = true;
+    while (grown) {
+      grown = false;
+      for (unsigned int lix = 0; lix < leaves.size(); lix++) {
+        auto wid = leaves[lix];
+        auto gix = driver[wid];
+        if ((gix == NO_DRIVER) || !is_mappable(ckt.allGates[gix].op) ||
+            (fanoutStart[wid + 1] - fanoutStart[wid] != 1)) {
+          continue;
+        }
+        GateIndexList grownLeaves(leaves);
+        grownLeaves.erase(grownLeaves.begin() + lix);
+        for (auto iw : ckt.allGates[gix].inWires) {
+          if (std::find(grownLeaves.begin(), grownLeaves.end(), iw) ==
+              grownLeaves.end()) {
+            grownLeaves.push_back(iw);
+          }
+        }
+        if (grownLeaves.size() > MAX_LUT_IN) {
+          continue;
+        }
+        leaves = grownLeaves;
+        cone.push_back(gix);
+        grown = true;
+        break;
+      }
+    }
+
+    unsigned int cost = 0;
+    for (auto gix : cone) {
+      cost += GateBootstrapCost(ckt.allGates[gix].op, xor_mode);
+    }
+    if (cost <= GateBootstrapCost(GateEnum::LUT3)) {
+      continue; // no bootstrap to save
+    }
+
+    // a LUT3 repeats a leaf when the cone has fewer than three, the table
+    // entries where the copies differ are never selected
+    while (leaves.size() < 3) {
+      leaves.push_back(leaves.back());
+    }
+    unsigned int table = 0;
+    for (unsigned int ix = 0; ix < (1u << leaves.size()); ix++) {
+      std::unordered_map<unsigned int, unsigned int> leafValue;
+      for (unsigned int bit = 0; bit < leaves.size(); bit++) {
+        leafValue.insert({leaves[bit], (ix >> bit) & 1}); // first copy wins
+      }
+      table |= eval_cone(ckt, driver, leafValue, r.outWires[0]) << ix;
+    }
+    replaced[root].op = (leaves.size() == 3) ? GateEnum::LUT3 : GateEnum::LUT4;
+    replaced[root].in = leaves;
+    replaced[root].table = table;
+    for (unsigned int cix = 1; cix < cone.size(); cix++) {
+      absorbed[cone[cix]] = true;
+    }
+    n_luts++;
+    n_packed += cone.size();
+  }
+
+  auto compiled = rebuild(ckt, absorbed, replaced);
+  if (!compiled) {
+    std::cerr << "Error mapping circuit to LUTs" << std::endl;
+    exit(-1);
+  }
+  std::cout << "mapped " << n_packed << " gates into " << n_luts
+            << " LUTs in " << TOC_MS(t_map) << " msec, bootstraps "
+            << CountBootstraps(ckt, xor_mode) << " -> "
+            << CountBootstraps(*compiled, xor_mode)
+            << std::endl;
+  return compiled;
+}
+
+std::shared_ptr<const CompiledCircuit> FuseGates(const CompiledCircuit &ckt,
+                                                 XorEnum xor_mode) {
+  // grow a tree back from every AND and OR gate, outputs first, by
+  // absorbing the driver of one of its leaf wires if it is a gate of the
+  // same op that nothing else reads, as long as the tree keeps at most
+  // four leaves. The root of a tree becomes one AND3/AND4 (OR3/OR4) gate
+  TIC(auto t_fuse);
+  auto driver = find_drivers(ckt);
+  auto const &fanoutStart = ckt.fanoutStart;
+  std::vector<bool> absorbed(ckt.allGates.size(), false);
+  std::vector<Replacement> replaced(ckt.allGates.size());
+  unsigned int n_fused = 0;
+  unsigned int n_trees = 0;
+  for (auto it = ckt.levelGates.rbegin(); it != ckt.levelGates.rend(); it++) {
+    unsigned int root = *it;
+    auto const &r = ckt.allGates[root];
+    if (absorbed[root] || ((r.op != GateEnum::AND) && (r.op != GateEnum::OR))) {
+      continue;
+    }
+    unsigned int n_tree = 1;
+    GateIndexList leaves;
+    for (auto iw : r.inWires) {
+      if (std::find(leaves.begin(), leaves.end(), iw) == leaves.end()) {
+        leaves.push_back(iw);
+      }
+    }
+    bool grown = true;
+    while (grown) {
+      grown = false;
+      for (unsigned int lix = 0; lix < leaves.size(); lix++) {
+        auto wid = leaves[lix];
+        auto gix = driver[wid];
+        if ((gix == NO_DRIVER) || (ckt.allGates[gix].op != r.op) ||
+            (fanoutStart[wid + 1] - fanoutStart[wid] != 1)) {
+          continue;
+        }
+        GateIndexList grownLeaves(leaves);
+        grownLeaves.erase(grownLeaves.begin() + lix);
+        for (auto iw : ckt.allGates[gix].inWires) {
+          if (std::find(grownLeaves.begin(), grownLeaves.end(), iw) ==
+              grownLeaves.end()) {
+            grownLeaves.push_back(iw);
+          }
+        }
+        if (grownLeaves.size() > MAX_FUSE_IN) {
+          continue;
+        }
+        leaves = grownLeaves;
+        absorbed[gix] = true;
+        n_tree++;
+        grown = true;
+        break;
+      }
+    }
+    if (n_tree == 1) {
+      continue;
+    }
+
+    // a tree whose leaves repeat may be left with fewer than three
+    bool is_and = (r.op == GateEnum::AND);
+    switch (leaves.size()) {
+    case 4:
+      replaced[root].op = is_and ? GateEnum::AND4 : GateEnum::OR4;
+      break;
+    case 3:
+      replaced[root].op = is_and ? GateEnum::AND3 : GateEnum::OR3;
+      break;
+    default:
+      replaced[root].op = r.op;
+      while (leaves.size() < 2) {
+        leaves.push_back(leaves.back());
+      }
+    }
+    replaced[root].in = leaves;
+    n_trees++;
+    n_fused += n_tree;
+  }
+
+  auto compiled = rebuild(ckt, absorbed, replaced);
+  if (!compiled) {
+    std::cerr << "Error fusing circuit gates" << std::endl;
+    exit(-1);
+  }
+  // the keys for the fused gates decompose XOR
+  auto fused_mode =
+      (compiled->RequiredEncoding().kind == EncodingEnum::MULTI_INPUT)
+          ? XorEnum::DECOMPOSED
+          : xor_mode;
+  auto n_boot = CountBootstraps(ckt, xor_mode);
+  auto n_fused_boot = CountBootstraps(*compiled, fused_mode);
+  if (n_fused_boot > n_boot) {
+    std::cout << "fusing would raise the bootstraps from " << n_boot
+              << " to " << n_fused_boot << ", circuit left as it is"
+              << std::endl;
+    return rebuild(ckt, std::vector<bool>(ckt.allGates.size(), false),
+                   std::vector<Replacement>(ckt.allGates.size()));
+  }
+  std::cout << "fused " << n_fused << " gates into " << n_trees
+            << " gates in " << TOC_MS(t_fuse) << " msec, bootstraps "
+            << n_boot << " -> " << n_fused_boot << std::endl;
+  return compiled;
+}
+
+// a cut of the cone of a gate: the gates of the cone and the wires that
+// feed it from outside, sorted
+struct Cut {
+  GateIndexList cone;
+  GateIndexList leaves;
+};
+
+// every cut of the cone of root with three leaves. The cone is grown
+// through NOT, AND, OR and XOR gates whatever their fanout, up to
+// MAX_MATCH_GATES gates with at most four leaves on the way
+static std::vector<Cut> find_cuts(const CompiledCircuit &ckt,
+                                  const GateIndexList &driver,
+                                  unsigned int root) {
+  std::vector<Cut> cuts;
+  std::set<GateIndexList> seen;
+  std::vector<Cut> work(1);
+  work[0].cone.push_back(root);
+  work[0].leaves = ckt.allGates[root].inWires;
+  std::sort(work[0].leaves.begin(), work[0].leaves.end());
+  work[0].leaves.erase(
+      std::unique(work[0].leaves.begin(), work[0].leaves.end()),
+      work[0].leaves.end());
+  while (!work.empty()) {
+    Cut cut = work.back();
+    work.pop_back();
+    if (cut.leaves.size() == 3) {
+      cuts.push_back(cut);
+    }
+    if (cut.cone.size() == MAX_MATCH_GATES) {
+      continue;
+    }
+    for (auto wid : cut.leaves) {
+      auto gix = driver[wid];
+      if ((gix == NO_DRIVER) || !is_mappable(ckt.allGates[gix].op)) {
+        continue;
+      }
+      Cut grown(cut);
+      grown.cone.push_back(gix);
+      grown.leaves.erase(
+          std::find(grown.leaves.begin(), grown.leaves.end(), wid));
+      bool inner = false; // an input is already computed in the cone
+      for (auto iw : ckt.allGates[gix].inWires) {
+        inner |= (driver[iw] != NO_DRIVER) &&
+                 (std::find(cut.cone.begin(), cut.cone.end(), driver[iw]) !=
+                  cut.cone.end());
+        grown.leaves.push_back(iw);
+      }
+      std::sort(grown.leaves.begin(), grown.leaves.end());
+      grown.leaves.erase(std::unique(grown.leaves.begin(), grown.leaves.end()),
+                         grown.leaves.end());
+      if (inner || (grown.leaves.size() > 4) ||
+          !seen.insert(grown.leaves).second) {
+        continue;
+      }
+      work.push_back(grown);
+    }
+  }
+  return cuts;
+}
+
+// the gate with inputs in computing table over three leaves, false if
+// it is neither a majority nor a multiplexer
+static bool match_table(unsigned int table, const GateIndexList &leaves,
+                        Replacement *rep) {
+  if (table == MAJORITY_TABLE) {
+    rep->op = GateEnum::MAJORITY;
+    rep->in = leaves;
+    return true;
+  }
+  for (unsigned int sel = 0; sel < 3; sel++) {
+    for (unsigned int d1 = 0; d1 < 3; d1++) {
+      unsigned int d0 = 3 - sel - d1;
+      if ((d1 == sel) || (d0 == sel)) {
+        continue;
+      }
+      unsigned int mux = 0;
+      for (unsigned int ix = 0; ix < 8; ix++) {
+        unsigned int bit = ((ix >> sel) & 1) ? d1 : d0;
+        mux |= ((ix >> bit) & 1) << ix;
+      }
+      if (table == mux) {
+        rep->op = GateEnum::CMUX;
+        rep->in = {leaves[d0], leaves[d1], leaves[sel]};
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// gates that any OUTPUT or DFF gate depends on, reading the inputs of the
+// replaced gates
+static std::vector<bool> find_live(const CompiledCircuit &ckt,
+                                   const GateIndexList &driver,
+                                   const std::vector<Replacement> &replaced) {
+  std::vector<bool> live(ckt.allGates.size(), false);
+  GateIndexList stack;
+  for (unsigned int gix = 0; gix < ckt.allGates.size(); gix++) {
+    auto op = ckt.allGates[gix].op;
+    if ((op == GateEnum::OUTPUT) || (op == GateEnum::DFF)) {
+      live[gix] = true;
+      stack.push_back(gix);
+    }
+  }
+  while (!stack.empty()) {
+    auto gix = stack.back();
+    stack.pop_back();
+    auto const &in = replaced[gix].in.empty() ? ckt.allGates[gix].inWires
+                                              : replaced[gix].in;
+    for (auto iw : in) {
+      auto d = driver[iw];
+      if ((d != NO_DRIVER) && !live[d]) {
+        live[d] = true;
+        stack.push_back(d);
+      }
+    }
+  }
+  return live;
+}
+
+std::shared_ptr<const CompiledCircuit>
+MatchPatterns(const CompiledCircuit &ckt, XorEnum xor_mode) {
+  // for every AND, OR and XOR gate, outputs first, find the cuts of its
+  // cone with three leaves whose truth table is a majority or a
+  // multiplexer of the leaves. The cut that saves the most bootstraps
+  // replaces the gate. A gate of the cone is saved if it is only read
+  // inside the cone, the gates left with no reader are dropped at the end
+  TIC(auto t_match);
+  auto driver = find_drivers(ckt);
+  auto const &fanoutStart = ckt.fanoutStart;
+  auto const &fanoutGates = ckt.fanoutGates;
+  std::vector<bool> absorbed(ckt.allGates.size(), false);
+  std::vector<Replacement> replaced(ckt.allGates.size());
+  unsigned int n_majority = 0;
+  unsigned int n_cmux = 0;
+  for (auto it = ckt.levelGates.rbegin(); it != ckt.levelGates.rend(); it++) {
+    unsigned int root = *it;
+    auto const &r = ckt.allGates[root];
+    if (absorbed[root] || !is_mappable(r.op) || (r.op == GateEnum::NOT)) {
+      continue;
+    }
+    int best_saved = 0;
+    Replacement best;
+    GateIndexList best_owned;
+    for (auto const &cut : find_cuts(ckt, driver, root)) {
+      unsigned int table = 0;
+      for (unsigned int ix = 0; ix < 8; ix++) {
+        std::unordered_map<unsigned int, unsigned int> leafValue;
+        for (unsigned int bit = 0; bit < 3; bit++) {
+          leafValue.insert({cut.leaves[bit], (ix >> bit) & 1});
+        }
+        table |= eval_cone(ckt, driver, leafValue, r.outWires[0]) << ix;
+      }
+      Replacement rep;
+      if (!match_table(table, cut.leaves, &rep)) {
+        continue;
+      }
+
+      // the gates of the cone read only by gates of the cone it owns
+      GateIndexList owned(1, root);
+      bool grown = true;
+      while (grown) {
+        grown = false;
+        for (auto gix : cut.cone) {
+          if (std::find(owned.begin(), owned.end(), gix) != owned.end()) {
+            continue;
+          }
+          auto wid = ckt.allGates[gix].outWires[0];
+          bool only_cone = true;
+          for (auto fix = fanoutStart[wid]; fix < fanoutStart[wid + 1];
+               fix++) {
+            only_cone &= std::find(owned.begin(), owned.end(),
+                                   fanoutGates[fix]) != owned.end();
+          }
+          if (only_cone) {
+            owned.push_back(gix);
+            grown = true;
+          }
+        }
+      }
+      int saved = -static_cast<int>(GateBootstrapCost(rep.op, xor_mode));
+      for (auto gix : owned) {
+        saved += GateBootstrapCost(ckt.allGates[gix].op, xor_mode);
+      }
+      if (saved > best_saved) {
+        best_saved = saved;
+        best = rep;
+        best_owned = owned;
+      }
+    }
+    if (best_saved == 0) {
+      continue;
+    }
+    replaced[root] = best;
+    for (unsigned int oix = 1; oix < best_owned.size(); oix++) {
+      absorbed[best_owned[oix]] = true;
+    }
+    if (best.op == GateEnum::MAJORITY) {
+      n_majority++;
+    } else {
+      n_cmux++;
+    }
+  }
+
+  // drop every gate the rewritten circuit no longer reads
+  auto live_before = find_live(ckt, driver, std::vector<Replacement>(
+                                                ckt.allGates.size()));
+  auto live_after = find_live(ckt, driver, replaced);
+  for (unsigned int gix = 0; gix < ckt.allGates.size(); gix++) {
+    absorbed[gix] = live_before[gix] && !live_after[gix];
+  }
+
+  auto compiled = rebuild(ckt, absorbed, replaced);
+  if (!compiled) {
+    std::cerr << "Error matching circuit patterns" << std::endl;
+    exit(-1);
+  }
+  std::cout << "matched " << n_majority << " MAJORITY and " << n_cmux
+            << " CMUX gates in " << TOC_MS(t_match) << " msec, bootstraps "
+            << CountBootstraps(ckt, xor_mode) << " -> "
+            << CountBootstraps(*compiled, xor_mode) << std::endl;
+  return compiled;
+}
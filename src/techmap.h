@@ -0,0 +1,79 @@
+// @file techmap.h -- technology mapping passes over a compiled circuit
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other
+// contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+#ifndef SRC_TECHMAP_H_
+#define SRC_TECHMAP_H_
+
+#include <memory>
+
+#include "compiled.h"
+
+// Passes that rewrite a loaded circuit into an equivalent one that needs
+// fewer bootstraps. Each builds a new CompiledCircuit and leaves its
+// argument alone, so it can be run on a circuit that is already shared.
+//
+// MapLuts packs cones of NOT, AND, OR and XOR gates with at most four
+// inputs into one LUT3 or LUT4 gate, which costs one functional
+// bootstrap whatever the cone computes. A gate can only be packed into
+// the cone of the gate it feeds if nothing else reads its output, so no
+// gate is computed twice. Cones that would not save a bootstrap with the
+// given XOR mode are left alone.
+std::shared_ptr<const CompiledCircuit>
+MapLuts(const CompiledCircuit &ckt, XorEnum xor_mode = XorEnum::DECOMPOSED);
+
+// FuseGates merges trees of AND gates (or of OR gates) with at most four
+// leaves into one AND3/AND4 (OR3/OR4) gate, which costs one bootstrap.
+// As in MapLuts, only gates read by nothing else are merged. Like LUTs,
+// encrypted multi-input gates need a crypto context set up for them, and
+// in it XOR is decomposed. So if that costs more bootstraps than fusing
+// saves with the given XOR mode, the circuit is left as it is.
+std::shared_ptr<const CompiledCircuit>
+FuseGates(const CompiledCircuit &ckt, XorEnum xor_mode = XorEnum::DECOMPOSED);
+
+// MatchPatterns replaces gates that compute the majority of three wires,
+// or select one of two wires with a third, by one MAJORITY or CMUX gate,
+// as in the carry chains of adders and in multiplexers. It looks at the
+// cones of up to six NOT, AND, OR and XOR gates feeding each gate, and
+// the gates of a cone may be read elsewhere too, so the cone is only
+// replaced if that saves bootstraps with the given XOR mode.
+std::shared_ptr<const CompiledCircuit>
+MatchPatterns(const CompiledCircuit &ckt,
+              XorEnum xor_mode = XorEnum::DECOMPOSED);
+
+// bootstraps spent by one encrypted evaluation of the circuit
+unsigned int CountBootstraps(const CompiledCircuit &ckt,
+                             XorEnum xor_mode = XorEnum::DECOMPOSED);
+
+#endif // SRC_TECHMAP_H_
@@ -0,0 +1,279 @@
+// @file test_batch.cpp -- test code for batched circuit evaluation
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other
+// contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+#include "./test_batch.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "busfile.h"
+#include "circuit.h"
+#include "client.h"
+#include "evaluation.h"
+#include "utils.h"
+
+/////
+
+//
+// test program to evaluate one circuit on a file of input records with
+// Circuit::EvaluateBatch()
+//
+// Description:
+// The record file has one evaluation per line, holding one hex number per
+// input bus (msb first, as written by printf %x). Blank lines and lines
+// starting with # are skipped. Every record is first run on its own with
+// SetInput/Clock in plaintext, then all of the records are run as one
+// plaintext batch and one encrypted batch, and both batches are compared
+// with the single runs. Last, each record is encrypted by a
+// CircuitClient, run on a keyless EvaluationState that only has the
+// client's bootstrapping keys, and decrypted by the client. The inputs
+// and outputs are passed between the client and the evaluator in
+// encrypted bus files written next to the record file. Finally two
+// EvaluationStates of the one loaded circuit are run at the same time on
+// two threads, each encrypting every other record.
+//
+// Input
+//   cktFname = circuit file, a Bristol Fashion .txt netlist or a .out
+//              assembler listing
+//   recordFname = file of input records
+// Output
+//   passed = if true then all tests passed
+//
+
+// output bus as hex, msb first
+static std::string to_hex(const std::vector<unsigned int> &bits) {
+  std::string hex;
+  for (int ix = (bits.size() + 3) / 4 - 1; ix >= 0; ix--) {
+    unsigned int nibble = 0;
+    for (unsigned int bix = 0; bix < 4; bix++) {
+      if (4 * ix + bix < bits.size()) {
+        nibble |= bits[4 * ix + bix] << bix;
+      }
+    }
+    hex.push_back("0123456789abcdef"[nibble]);
+  }
+  return hex;
+}
+
+static std::vector<Inputs> read_records(std::string recordFname,
+                                        std::vector<unsigned int> in_bits) {
+  std::ifstream inFile(recordFname);
+  if (!inFile) {
+    std::cerr << "can't open record file " << recordFname << std::endl;
+    exit(-1);
+  }
+  std::vector<Inputs> records;
+  std::string line;
+  unsigned int line_no = 0;
+  while (std::getline(inFile, line)) {
+    line_no++;
+    std::istringstream iss(line);
+    std::string tok;
+    Inputs record;
+    while (iss >> tok) {
+      if (record.empty() && tok[0] == '#') {
+        break; // comment
+      }
+      record.push_back(HexStr2UintVec(tok));
+    }
+    if (record.empty()) {
+      continue;
+    }
+    if (record.size() != in_bits.size()) {
+      std::cerr << recordFname << ":" << line_no << " has " << record.size()
+                << " inputs, the circuit has " << in_bits.size()
+                << std::endl;
+      exit(-1);
+    }
+    // trim each bus to its width, the bits dropped must be zero
+    for (unsigned int ix = 0; ix < record.size(); ix++) {
+      for (unsigned int bix = in_bits[ix]; bix < record[ix].size(); bix++) {
+        if (record[ix][bix]) {
+          std::cerr << recordFname << ":" << line_no << " input " << ix
+                    << " is wider than " << in_bits[ix] << " bits"
+                    << std::endl;
+          exit(-1);
+        }
+      }
+      record[ix].resize(in_bits[ix], 0);
+    }
+    records.push_back(record);
+  }
+  return records;
+}
+
+bool test_batch(std::string cktFname, std::string recordFname,
+                std::shared_ptr<const CircuitClient> keys,
+                ExecutorEnum executor, ScheduleEnum schedule) {
+  std::cout << "test_batch: Opening file " << cktFname << std::endl;
+
+  Circuit circ(keys);
+  circ.setExecutor(executor);
+  circ.setSchedule(schedule);
+  bool success;
+  if (contains(cktFname, ".txt")) {
+    success = circ.ReadBristolFile(cktFname, true);
+  } else {
+    success = circ.ReadFile(cktFname);
+  }
+  if (!success) {
+    std::cerr << "error parsing file " << cktFname << std::endl;
+    exit(-1);
+  }
+
+  auto records = read_records(recordFname, circ.getInputBits());
+  std::cout << "read " << records.size() << " records from " << recordFname
+            << std::endl;
+
+  // one at a time
+  std::vector<Outputs> out_good;
+  for (auto const &record : records) {
+    circ.Reset();
+    circ.setPlaintext(true);
+    circ.SetInput(record);
+    out_good.push_back(circ.Clock());
+  }
+
+  std::cout << "executing plaintext batch" << std::endl;
+  circ.Reset();
+  circ.setPlaintext(true);
+  auto out_plain = circ.EvaluateBatch(records);
+
+  std::cout << "executing encrypted batch" << std::endl;
+  circ.Reset();
+  circ.setEncrypted(true);
+  auto out_enc = circ.EvaluateBatch(records);
+
+  std::cout << "executing keyless evaluations" << std::endl;
+  EvaluationState server(circ.getCompiledCircuit(), keys->getContext(),
+                         nullptr);
+  server.setExecutor(std::shared_ptr<Executor>(MakeExecutor(executor)));
+  // the ciphertexts go between the two sides in bus files
+  std::string inBusFname = recordFname + ".in.ebus";
+  std::string outBusFname = recordFname + ".out.ebus";
+  std::vector<Outputs> out_keyless;
+  for (auto const &record : records) {
+    // client side
+    if (!WriteBusFile(inBusFname, keys->Encrypt(record))) {
+      exit(-1);
+    }
+    // server side
+    EncInputs encin;
+    if (!ReadBusFile(inBusFname, &encin)) {
+      exit(-1);
+    }
+    server.Reset();
+    server.setEncrypted(true);
+    server.SetEncryptedInput(encin);
+    server.Clock();
+    if (!WriteBusFile(outBusFname, server.getEncryptedOutputs())) {
+      exit(-1);
+    }
+    // client side
+    EncOutputs encout;
+    if (!ReadBusFile(outBusFname, &encout)) {
+      exit(-1);
+    }
+    out_keyless.push_back(keys->Decrypt(encout));
+  }
+
+  std::cout << "executing concurrent evaluations" << std::endl;
+  // the states share the compiled circuit and the keys, each has its
+  // own wire values and executor, with its share of the cores
+  const unsigned int n_states = 2;
+  std::vector<std::unique_ptr<EvaluationState>> states;
+  for (unsigned int six = 0; six < n_states; six++) {
+    states.push_back(circ.NewEvaluationState(n_states));
+  }
+  std::vector<Outputs> out_shared(records.size());
+  std::vector<std::thread> threads;
+  for (unsigned int six = 0; six < n_states; six++) {
+    threads.push_back(std::thread([&states, &records, &out_shared, six] {
+      EvaluationState &es = *states[six];
+      for (unsigned int rix = six; rix < records.size(); rix += n_states) {
+        es.Reset();
+        es.setEncrypted(true);
+        es.SetInput(records[rix]);
+        out_shared[rix] = es.Clock();
+      }
+    }));
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  unsigned int n_p_passed(0);
+  unsigned int n_e_passed(0);
+  unsigned int n_k_passed(0);
+  unsigned int n_c_passed(0);
+  for (unsigned int rix = 0; rix < records.size(); rix++) {
+    std::cout << "record " << rix << ":";
+    for (auto const &bus : out_enc[rix]) {
+      std::cout << " " << to_hex(bus);
+    }
+    if (out_plain[rix] == out_good[rix]) {
+      n_p_passed++;
+    } else {
+      std::cout << " plaintext batch does not match";
+    }
+    if (out_enc[rix] == out_good[rix]) {
+      n_e_passed++;
+    } else {
+      std::cout << " encrypted batch does not match";
+    }
+    if (out_keyless[rix] == out_good[rix]) {
+      n_k_passed++;
+    } else {
+      std::cout << " keyless evaluation does not match";
+    }
+    if (out_shared[rix] == out_good[rix]) {
+      n_c_passed++;
+    } else {
+      std::cout << " concurrent evaluation does not match";
+    }
+    std::cout << std::endl;
+  }
+
+  std::cout << "# records: " << records.size() << std::endl;
+  std::cout << "# passed plaintext: " << n_p_passed << std::endl;
+  std::cout << "# passed encrypted: " << n_e_passed << std::endl;
+  std::cout << "# passed keyless: " << n_k_passed << std::endl;
+  std::cout << "# passed concurrent: " << n_c_passed << std::endl;
+  return (n_p_passed == records.size()) && (n_e_passed == records.size()) &&
+         (n_k_passed == records.size()) && (n_c_passed == records.size());
+}
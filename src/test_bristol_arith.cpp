@@ -0,0 +1,336 @@
+// @file test_bristol_arith.cpp -- runs bristol fashion arith circuits
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other
+// contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+#include "./test_bristol_arith.h"
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "circuit.h"
+#include "utils.h"
+
+/////
+
+//
+// test program to run the new style ("Bristol Fashion") arithmetic circuits
+// provided at <https://homes.esat.kuleuven.be/~nsmart/MPC/>
+//
+// Description:
+// Unlike the other test programs this one does not use an assembled .out
+// file, the circuit is loaded directly from the Bristol Fashion netlist with
+// Circuit::ReadBristolFile(). It generates random 64 bit inputs, computes the
+// expected result for the operation named in the file name, and compares it
+// with both the plaintext and the encrypted evaluation of the circuit. The
+// plaintext run is repeated with each schedule, the encrypted one uses the
+// schedule selected for the circuit.
+// Bristol Fashion wire k of a bus is bit k of the word (lsb first).
+//
+// Input
+//   inFname = input filename containing the bristol fashion circuit
+//   numTestLoops = number of times to test program
+// Output
+//   passed = if true then all tests passed
+//
+
+// high 64 bits of the 128 bit product a*b
+static uint64_t mulhi64(uint64_t a, uint64_t b) {
+  uint64_t a_lo = a & 0xFFFFFFFF;
+  uint64_t a_hi = a >> 32;
+  uint64_t b_lo = b & 0xFFFFFFFF;
+  uint64_t b_hi = b >> 32;
+
+  uint64_t lo_lo = a_lo * b_lo;
+  uint64_t hi_lo = a_hi * b_lo;
+  uint64_t lo_hi = a_lo * b_hi;
+  uint64_t hi_hi = a_hi * b_hi;
+
+  uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+  return hi_hi + (hi_lo >> 32) + (cross >> 32);
+}
+
+static std::vector<unsigned int> to_bits(uint64_t val, unsigned int n_bits) {
+  std::vector<unsigned int> bits(n_bits);
+  for (unsigned int ix = 0; ix < n_bits; ix++) {
+    bits[ix] = (val >> ix) & 1;
+  }
+  return bits;
+}
+
+static void print_bits(std::vector<unsigned int> bits) {
+  for (int ix = bits.size() - 1; ix >= 0; ix--) {
+    std::cout << bits[ix];
+  }
+  std::cout << std::endl;
+}
+
+bool test_bristol_arith(std::string inFname, unsigned int numTestLoops,
+                        std::shared_ptr<const CircuitClient> keys,
+                        ExecutorEnum executor, ScheduleEnum schedule) {
+  std::cout << "test_bristol_arith: Opening file " << inFname << std::endl;
+
+  unsigned int n_in_bits(64);
+  unsigned int n_inputs(2);
+  if (contains(inFname, "neg64") || contains(inFname, "zero_equal")) {
+    n_inputs = 1;
+  }
+
+  Circuit circ(keys);
+  circ.setExecutor(executor);
+  circ.setSchedule(schedule);
+  bool success = circ.ReadBristolFile(inFname, true);
+  if (!success) {
+    std::cerr << "error parsing file " << inFname << std::endl;
+    exit(-1);
+  }
+
+  unsigned int n_p_passed(0);
+  unsigned int n_e_passed(0);
+  unsigned int n_xor_mismatches(0);
+
+  //  loop over tests
+  bool passed = true;
+
+  Inputs inputs(n_inputs);
+  std::cout << "testing " << numTestLoops << " iterations" << std::endl;
+  for (uint test_ix = 0; test_ix < numTestLoops; test_ix++) {
+    std::cout << "test " << test_ix << std::endl;
+
+    // generate random inputs
+    srand(test_ix); // set the random number generator to a known seed
+    uint64_t a(0);
+    uint64_t b(0);
+    for (uint ix = 0; ix < n_in_bits; ix++) {
+      a |= uint64_t(rand() % 2) << ix;
+      b |= uint64_t(rand() % 2) << ix;
+    }
+
+    // the first test of zero_equal needs a zero to test the true case
+    if ((test_ix == 0) && contains(inFname, "zero_equal")) {
+      a = 0;
+    }
+
+    // generate the test output
+    std::vector<std::vector<unsigned int>> out_good;
+    if (contains(inFname, "adder64")) {
+      std::cout << a << " + " << b << std::endl;
+      out_good.push_back(to_bits(a + b, 64));
+    } else if (contains(inFname, "sub64")) {
+      std::cout << a << " - " << b << std::endl;
+      out_good.push_back(to_bits(a - b, 64));
+    } else if (contains(inFname, "neg64")) {
+      std::cout << "-" << int64_t(a) << std::endl;
+      out_good.push_back(to_bits(~a + 1, 64));
+    } else if (contains(inFname, "zero_equal")) {
+      std::cout << a << " == 0" << std::endl;
+      out_good.push_back(to_bits(a == 0, 1));
+    } else if (contains(inFname, "mult2_64")) {
+      // full product, first output is the high word
+      std::cout << a << " * " << b << std::endl;
+      out_good.push_back(to_bits(mulhi64(a, b), 64));
+      out_good.push_back(to_bits(a * b, 64));
+    } else if (contains(inFname, "mult64")) {
+      std::cout << a << " * " << b << std::endl;
+      out_good.push_back(to_bits(a * b, 64));
+    } else if (contains(inFname, "udivide64")) {
+      // the published udivide64 circuit returns wrong quotients when the
+      // msb of the divisor is set, so keep the divisor below 2^63
+      b &= ~(uint64_t(1) << 63);
+      if (b == 0) {
+        b = 1;
+      }
+      std::cout << a << " / " << b << std::endl;
+      out_good.push_back(to_bits(a / b, 64));
+    } else if (contains(inFname, "divide64")) {
+      int64_t ia = int64_t(a);
+      int64_t ib = int64_t(b);
+      // avoid division by zero and the one signed overflow
+      if ((ib == 0) || ((ib == -1) && (ia == INT64_MIN))) {
+        ib = 1;
+      }
+      b = uint64_t(ib);
+      std::cout << ia << " / " << ib << std::endl;
+      out_good.push_back(to_bits(uint64_t(ia / ib), 64));
+    } else {
+      std::cout << "unknown arithmetic circuit " << inFname << std::endl;
+      exit(-1);
+    }
+
+    inputs[0] = to_bits(a, n_in_bits);
+    if (n_inputs == 2) {
+      inputs[1] = to_bits(b, n_in_bits);
+    }
+    for (unsigned int ii = 0; ii < inputs.size(); ii++) {
+      std::cout << " input " << ii << ":  ";
+      print_bits(inputs[ii]);
+    }
+    for (unsigned int ii = 0; ii < out_good.size(); ii++) {
+      std::cout << " output " << ii << ": ";
+      print_bits(out_good[ii]);
+    }
+
+    //  execute program in circuit
+
+    std::cout << "executing circuit" << std::endl;
+    circ.Reset();
+    circ.setPlaintext(true);
+    circ.setEncrypted(false);
+    circ.setVerify(false);
+    circ.SetInput(inputs);
+    Outputs out_plain = circ.Clock();
+    std::cout << "program done" << std::endl;
+    if (test_ix == 0)
+      circ.dumpGateCount();
+
+    //  compare plaintext output with known good answer
+    if (out_plain == out_good) {
+      std::cout << "output match " << std::endl;
+      n_p_passed++;
+    } else {
+      for (unsigned int ii = 0; ii < out_plain.size(); ii++) {
+        std::cout << "plain computed out " << ii << ": ";
+        print_bits(out_plain[ii]);
+      }
+      std::cout << "output does not match" << std::endl;
+      passed = false;
+    }
+
+    //  and with the other schedules
+    for (auto sched :
+         {ScheduleEnum::DYNAMIC, ScheduleEnum::LEVEL, ScheduleEnum::ASYNC}) {
+      if (sched == schedule) {
+        continue;
+      }
+      circ.setSchedule(sched);
+      circ.Reset();
+      circ.setPlaintext(true);
+      circ.SetInput(inputs);
+      if (circ.Clock() == out_good) {
+        std::cout << ScheduleName(sched) << " output match " << std::endl;
+      } else {
+        std::cout << ScheduleName(sched) << " output does not match"
+                  << std::endl;
+        passed = false;
+      }
+    }
+    circ.setSchedule(schedule);
+
+    //  execute program in encrypted circuit evaluator
+
+    std::cout << "executing encrypted circuit with "
+              << ScheduleName(schedule) << " schedule" << std::endl;
+    circ.Reset();
+    circ.setPlaintext(false);
+    circ.setEncrypted(true);
+    circ.setVerify(true);
+    circ.SetInput(inputs);
+    // collect the output bits and ciphertexts as they are delivered,
+    // before Clock returns
+    Outputs out_streamed;
+    EncOutputs enc_streamed;
+    for (auto &out : out_good) {
+      out_streamed.push_back(std::vector<unsigned int>(out.size(), 0));
+      enc_streamed.push_back(CipherTextList(out.size()));
+    }
+    std::atomic<unsigned int> n_streamed(0);
+    std::atomic<uint64_t> first_bit_time(0);
+    TIC(auto t_enc);
+    circ.setOutputCallback([&](unsigned int bus, unsigned int bit,
+                               unsigned int value, const CipherText &ct) {
+      if (bus < out_streamed.size() && bit < out_streamed[bus].size()) {
+        out_streamed[bus][bit] = value;
+        enc_streamed[bus][bit] = ct;
+      }
+      if (n_streamed++ == 0) {
+        first_bit_time = TOC_MS(t_enc);
+      }
+    });
+    Outputs out_enc = circ.Clock();
+    auto enc_time = TOC_MS(t_enc);
+    circ.setOutputCallback(nullptr);
+    n_xor_mismatches += circ.getMismatches(GateEnum::XOR);
+    std::cout << "program done" << std::endl;
+    std::cout << "first of " << n_streamed << " output bits after "
+              << first_bit_time << " of " << enc_time << " msec" << std::endl;
+    if (out_streamed != out_enc) {
+      std::cout << "streamed output does not match" << std::endl;
+      passed = false;
+    }
+    // the streamed ciphertexts are the encrypted outputs of the circuit
+    if (enc_streamed != circ.getEncryptedOutputs()) {
+      std::cout << "streamed ciphertexts do not match" << std::endl;
+      passed = false;
+    }
+
+    //  compare encrypted output with known good answer
+    if (out_enc == out_good) {
+      std::cout << "output match " << std::endl;
+      n_e_passed++;
+    } else {
+      for (unsigned int ii = 0; ii < out_enc.size(); ii++) {
+        std::cout << "enc computed out " << ii << ": ";
+        print_bits(out_enc[ii]);
+      }
+      std::cout << "output does not match" << std::endl;
+      passed = false;
+    }
+
+    //  and once more without verify, which would repair every gate that
+    //  goes wrong. This is the result a server without the secret key gets
+
+    if (test_ix == 0) {
+      std::cout << "executing encrypted circuit without verify" << std::endl;
+      circ.Reset();
+      circ.setPlaintext(false);
+      circ.setEncrypted(true);
+      circ.SetInput(inputs);
+      if (circ.Clock() == out_good) {
+        std::cout << "unverified output match " << std::endl;
+      } else {
+        std::cout << "unverified output does not match" << std::endl;
+        passed = false;
+      }
+    }
+  } // for test_ix
+  std::cout << "# tests total: " << numTestLoops << std::endl;
+  std::cout << "# passed plaintext: " << n_p_passed << std::endl;
+  std::cout << "# passed encrypted: " << n_e_passed << std::endl;
+  std::cout << "# " << XorModeName(circ.getXorMode())
+            << " XOR mismatches: " << n_xor_mismatches << std::endl;
+
+  return passed;
+}
@@ -0,0 +1,162 @@
+// @file test_chain.cpp -- runs a chain of bristol fashion arith circuits
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other
+// contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+#include "./test_chain.h"
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "chain.h"
+#include "circuit.h"
+#include "utils.h"
+
+/////
+
+//
+// test program to run a chain of new style ("Bristol Fashion") arithmetic
+// circuits as one circuit
+//
+// Description:
+// adder64.txt, mult64.txt and sub64.txt are chained with CircuitChain
+// to compute ((a + b) * c) - d, with the sum feeding the multiplier and
+// the product feeding the subtractor on encrypted wires. The chain has
+// the four inputs a, b, c and d and one output. Random inputs are
+// compared with the plaintext and the encrypted evaluation of the chain.
+//
+// Input
+//   dirPath = directory holding the bristol fashion arith circuits
+//   numTestLoops = number of times to test program
+// Output
+//   passed = if true then all tests passed
+//
+
+static std::vector<unsigned int> to_bits(uint64_t val, unsigned int n_bits) {
+  std::vector<unsigned int> bits(n_bits);
+  for (unsigned int ix = 0; ix < n_bits; ix++) {
+    bits[ix] = (val >> ix) & 1;
+  }
+  return bits;
+}
+
+static std::shared_ptr<const CompiledCircuit> load(std::string fname) {
+  auto ckt = std::make_shared<CompiledCircuit>();
+  if (!ckt->ReadBristolFile(fname, true)) {
+    std::cerr << "error parsing file " << fname << std::endl;
+    exit(-1);
+  }
+  return ckt;
+}
+
+bool test_chain(std::string dirPath, unsigned int numTestLoops,
+                std::shared_ptr<const CircuitClient> keys,
+                ExecutorEnum executor, ScheduleEnum schedule) {
+  std::cout << "test_chain: chaining circuits in " << dirPath << std::endl;
+
+  CircuitChain chain;
+  auto add = chain.AddStage(load(dirPath + "/adder64.txt"));
+  auto mul = chain.AddStage(load(dirPath + "/mult64.txt"));
+  auto sub = chain.AddStage(load(dirPath + "/sub64.txt"));
+  chain.Bind(mul, 0, add, 0); // (a + b) * c
+  chain.Bind(sub, 0, mul, 0); // ((a + b) * c) - d
+
+  Circuit circ(keys);
+  circ.setExecutor(executor);
+  circ.setSchedule(schedule);
+  circ.setCompiledCircuit(chain.Compile());
+
+  unsigned int n_p_passed(0);
+  unsigned int n_e_passed(0);
+
+  //  loop over tests
+  bool passed = true;
+
+  std::cout << "testing " << numTestLoops << " iterations" << std::endl;
+  for (uint test_ix = 0; test_ix < numTestLoops; test_ix++) {
+    std::cout << "test " << test_ix << std::endl;
+
+    // generate random inputs
+    srand(test_ix); // set the random number generator to a known seed
+    std::vector<uint64_t> val(4, 0);
+    for (uint ix = 0; ix < 64; ix++) {
+      for (auto &v : val) {
+        v |= uint64_t(rand() % 2) << ix;
+      }
+    }
+    std::cout << "((" << val[0] << " + " << val[1] << ") * " << val[2]
+              << ") - " << val[3] << std::endl;
+
+    Inputs inputs;
+    for (auto v : val) {
+      inputs.push_back(to_bits(v, 64));
+    }
+    Outputs out_good(1, to_bits((val[0] + val[1]) * val[2] - val[3], 64));
+
+    //  execute program in circuit
+
+    std::cout << "executing circuit" << std::endl;
+    circ.Reset();
+    circ.setPlaintext(true);
+    circ.SetInput(inputs);
+    Outputs out_plain = circ.Clock();
+    if (out_plain == out_good) {
+      std::cout << "output match " << std::endl;
+      n_p_passed++;
+    } else {
+      std::cout << "output does not match" << std::endl;
+      passed = false;
+    }
+
+    //  execute program in encrypted circuit evaluator
+
+    std::cout << "executing encrypted circuit" << std::endl;
+    circ.Reset();
+    circ.setVerify(true);
+    circ.SetInput(inputs);
+    Outputs out_enc = circ.Clock();
+    if (out_enc == out_good) {
+      std::cout << "output match " << std::endl;
+      n_e_passed++;
+    } else {
+      std::cout << "output does not match" << std::endl;
+      passed = false;
+    }
+  } // for test_ix
+  std::cout << "# tests total: " << numTestLoops << std::endl;
+  std::cout << "# passed plaintext: " << n_p_passed << std::endl;
+  std::cout << "# passed encrypted: " << n_e_passed << std::endl;
+
+  return passed;
+}
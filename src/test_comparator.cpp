@@ -67,7 +67,8 @@
 // generates a random input set, and computes the appropriate output. It then
 // runs the program through the ECE and compares results. the first pass through
 // always sets the two inputs to each other in order to test equality filename
-// containing lteq triggers <= compare otherwise < is computed
+// containing lteq triggers <= compare otherwise < is computed. The encrypted
+// run is repeated with each schedule.
 //
 // Input
 //   inFname = input filename containing the program
@@ -83,8 +84,8 @@
 //
 
 bool test_comparator(std::string inFname, unsigned int numTestLoops,
-                     lbcrypto::BINFHE_PARAMSET set,
-                     lbcrypto::BINFHE_METHOD method) {
+                     std::shared_ptr<const CircuitClient> keys,
+                     ExecutorEnum executor, ScheduleEnum schedule) {
   // BLU_test_adder: tests BLU with adder programs
   std::cout << "test_comparator: Opening file " << inFname
             << " for test_adder parameters" << std::endl;
@@ -156,7 +157,9 @@ bool test_comparator(std::string inFname, unsigned int numTestLoops,
     exit(-1);
   }
 
-  Circuit circ(set, method);
+  Circuit circ(keys);
+  circ.setExecutor(executor);
+  circ.setSchedule(schedule);
   bool success = circ.ReadFile(inFname);
   if (!success) {
     std::cerr << "error parsing file " << inFname << std::endl;
@@ -319,38 +322,56 @@ bool test_comparator(std::string inFname, unsigned int numTestLoops,
       std::cout << "output does not match" << std::endl;
       passed = passed & false;
     }
-    //  execute program in encrypted circuit evaluator
-
-    std::cout << "executing encrypted circuit" << std::endl;
-    circ.Reset();
-    circ.setPlaintext(false);
-    circ.setEncrypted(true);
-    circ.setVerify(true);
-    circ.SetInput(inputs);
-    outputs = circ.Clock();
-    // circ.dumpGateCount();
-    std::cout << "program done" << std::endl;
-    auto out_enc = out;
-    // map output registers
-    for (auto outreg : outputs) {
-      unsigned int bit_ix = 0;
-      for (auto outbit : outreg) {
-        out_enc[bit_ix] = outbit;
-        bit_ix++;
+    //  execute program in encrypted circuit evaluator, once with each
+    //  schedule, starting with the one selected for the circuit
+
+    std::vector<ScheduleEnum> schedules = {schedule};
+    for (auto sched : {ScheduleEnum::DYNAMIC, ScheduleEnum::LEVEL,
+                       ScheduleEnum::ASYNC}) {
+      if (sched != schedules[0]) {
+        schedules.push_back(sched);
       }
     }
-    //  compare plaintext output with known good answer
-    if (out_enc == out_good) {
-      std::cout << "output match " << std::endl;
-      passed = passed & true;
+    bool enc_passed = true;
+    for (auto sched : schedules) {
+      std::cout << "executing encrypted circuit with " << ScheduleName(sched)
+                << " schedule" << std::endl;
+      circ.setSchedule(sched);
+      circ.Reset();
+      circ.setPlaintext(false);
+      circ.setEncrypted(true);
+      circ.setVerify(true);
+      circ.SetInput(inputs);
+      outputs = circ.Clock();
+      // circ.dumpGateCount();
+      std::cout << "program done" << std::endl;
+      auto out_enc = out;
+      // map output registers
+      for (auto outreg : outputs) {
+        unsigned int bit_ix = 0;
+        for (auto outbit : outreg) {
+          out_enc[bit_ix] = outbit;
+          bit_ix++;
+        }
+      }
+      //  compare plaintext output with known good answer
+      if (out_enc == out_good) {
+        std::cout << "output match " << std::endl;
+      } else {
+        std::cout << "enc computed  out: ";
+        for (int ix = n_out_bits[0] - 1; ix >= 0; ix--) {
+          std::cout << out_enc[ix];
+        }
+        std::cout << std::endl;
+        std::cout << ScheduleName(sched) << " output does not match"
+                  << std::endl;
+        enc_passed = false;
+      }
+    }
+    circ.setSchedule(schedules[0]);
+    if (enc_passed) {
       n_e_passed++;
     } else {
-      std::cout << "enc computed  out: ";
-      for (int ix = n_out_bits[0] - 1; ix >= 0; ix--) {
-        std::cout << out_enc[ix];
-      }
-      std::cout << std::endl;
-      std::cout << "output does not match" << std::endl;
       passed = passed & false;
     }
   } // for test_ix
@@ -36,14 +36,19 @@
 #ifndef SRC_TEST_COMPARATOR_H_
 #define SRC_TEST_COMPARATOR_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "binfhecontext.h"
 
+#include "client.h"
+#include "evaluation.h"
+#include "executor.h"
+
 // function declaration
 bool test_comparator(std::string outputFname, unsigned int num_test_loops,
-                     lbcrypto::BINFHE_PARAMSET set,
-                     lbcrypto::BINFHE_METHOD method);
+                     std::shared_ptr<const CircuitClient> keys,
+                     ExecutorEnum executor, ScheduleEnum schedule);
 
 #endif // SRC_TEST_COMPARATOR_H_
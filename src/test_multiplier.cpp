@@ -82,8 +82,8 @@
 //
 
 bool test_multiplier(std::string inFname, unsigned int numTestLoops,
-                     lbcrypto::BINFHE_PARAMSET set,
-                     lbcrypto::BINFHE_METHOD method) {
+                     std::shared_ptr<const CircuitClient> keys,
+                     ExecutorEnum executor, ScheduleEnum schedule) {
   // BLU_test_multiplier: tests BLU with multiplier programs
   std::cout << "Opening file " << inFname << " for test_multiplier parameters"
             << std::endl;
@@ -155,7 +155,9 @@ bool test_multiplier(std::string inFname, unsigned int numTestLoops,
     exit(-1);
   }
 
-  Circuit circ(set, method);
+  Circuit circ(keys);
+  circ.setExecutor(executor);
+  circ.setSchedule(schedule);
   bool success = circ.ReadFile(inFname);
   if (!success) {
     std::cerr << "error parsing file " << inFname << std::endl;
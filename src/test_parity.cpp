@@ -79,8 +79,8 @@
 //
 
 bool test_parity(std::string inFname, unsigned int numTestLoops,
-                 lbcrypto::BINFHE_PARAMSET set,
-                 lbcrypto::BINFHE_METHOD method) {
+                 std::shared_ptr<const CircuitClient> keys,
+                 ExecutorEnum executor, ScheduleEnum schedule) {
   // BLU_test_parity: tests BLU with parity programs
   std::cout << "test_parity: Opening file " << inFname
             << " for test_parity parameters" << std::endl;
@@ -149,7 +149,9 @@ bool test_parity(std::string inFname, unsigned int numTestLoops,
     exit(-1);
   }
 
-  Circuit circ(set, method);
+  Circuit circ(keys);
+  circ.setExecutor(executor);
+  circ.setSchedule(schedule);
   bool success = circ.ReadFile(inFname);
   if (!success) {
     std::cout << "error parsing file " << inFname << std::endl;
@@ -37,11 +37,17 @@
 #define TEST_PARITY_H
 
 #include "binfhecontext.h"
+
+#include "client.h"
+#include "evaluation.h"
+#include "executor.h"
+#include <memory>
 #include <string>
 #include <vector>
 
 // function declaration
 bool test_parity(std::string outputFname, unsigned int num_test_loops,
-                 lbcrypto::BINFHE_PARAMSET set, lbcrypto::BINFHE_METHOD method);
+                 std::shared_ptr<const CircuitClient> keys,
+                 ExecutorEnum executor, ScheduleEnum schedule);
 
 #endif
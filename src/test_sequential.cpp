@@ -0,0 +1,206 @@
+// @file test_sequential.cpp -- test code for clocked circuits with DFFs
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other
+// contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+#include "./test_sequential.h"
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "circuit.h"
+#include "utils.h"
+
+/////
+
+//
+// test program to run a sequential circuit over several clock cycles
+//
+// Description:
+// an n bit accumulator is written as an assembler listing (.out) with
+// DFF registers holding the sum. Every cycle it adds y = x XOR k to the
+// sum and outputs the new sum. x and k are the two inputs, so the XORs
+// only depend on the inputs while the adder is clocked. Each test runs
+// the cycles set, set, hold, set: in the held cycle no new inputs are
+// given and only the adder is run, adding the last y again. The sums
+// are compared with the plaintext and the encrypted evaluation.
+//
+// Input
+//   cktFname = file the accumulator listing is written to
+//   numTestLoops = number of times to test program
+// Output
+//   passed = if true then all tests passed
+//
+
+static const unsigned int N_BITS = 16;
+static const unsigned int N_CYCLES = 4;
+static const unsigned int HOLD_CYCLE = 2;
+
+static std::vector<unsigned int> to_bits(uint64_t val, unsigned int n_bits) {
+  std::vector<unsigned int> bits(n_bits);
+  for (unsigned int ix = 0; ix < n_bits; ix++) {
+    bits[ix] = (val >> ix) & 1;
+  }
+  return bits;
+}
+
+static void write_accumulator(std::string fname, unsigned int n_bits) {
+  // sum[i] = DFF(next[i]), next = sum + (x ^ k) with a ripple carry adder
+  std::ofstream out(fname);
+  if (!out) {
+    std::cerr << "error opening file " << fname << std::endl;
+    exit(-1);
+  }
+  unsigned int n_reg = 0;
+  auto reg = [&n_reg](void) { return "R" + std::to_string(n_reg++); };
+  std::vector<std::string> x(n_bits), k(n_bits), sum(n_bits), next(n_bits);
+  out << "# " << n_bits << " bit accumulator of x XOR k" << std::endl;
+  for (unsigned int ix = 0; ix < n_bits; ix++) {
+    x[ix] = reg();
+    out << x[ix] << " = LOAD(In1, " << ix << ")" << std::endl;
+    k[ix] = reg();
+    out << k[ix] << " = LOAD(In2, " << ix << ")" << std::endl;
+    sum[ix] = reg();
+    next[ix] = reg();
+    out << sum[ix] << " = DFF(" << next[ix] << ")" << std::endl;
+  }
+  std::string carry;
+  for (unsigned int ix = 0; ix < n_bits; ix++) {
+    auto y = reg();
+    out << y << " = XOR(" << x[ix] << ", " << k[ix] << ")" << std::endl;
+    auto gen = reg();
+    out << gen << " = AND(" << sum[ix] << ", " << y << ")" << std::endl;
+    if (ix == 0) {
+      out << next[ix] << " = XOR(" << sum[ix] << ", " << y << ")"
+          << std::endl;
+      carry = gen;
+      continue;
+    }
+    auto prop = reg();
+    out << prop << " = XOR(" << sum[ix] << ", " << y << ")" << std::endl;
+    out << next[ix] << " = XOR(" << prop << ", " << carry << ")" << std::endl;
+    auto pc = reg();
+    out << pc << " = AND(" << prop << ", " << carry << ")" << std::endl;
+    carry = reg();
+    out << carry << " = OR(" << gen << ", " << pc << ")" << std::endl;
+  }
+  for (unsigned int ix = 0; ix < n_bits; ix++) {
+    out << "Out" << ix << " = STORE(" << next[ix] << ")" << std::endl;
+  }
+}
+
+bool test_sequential(std::string cktFname, unsigned int numTestLoops,
+                     std::shared_ptr<const CircuitClient> keys,
+                     ExecutorEnum executor, ScheduleEnum schedule) {
+  std::cout << "test_sequential: writing accumulator " << cktFname
+            << std::endl;
+  write_accumulator(cktFname, N_BITS);
+
+  Circuit circ(keys);
+  circ.setExecutor(executor);
+  circ.setSchedule(schedule);
+  if (!circ.ReadFile(cktFname)) {
+    std::cerr << "error parsing file " << cktFname << std::endl;
+    exit(-1);
+  }
+
+  unsigned int n_p_passed(0);
+  unsigned int n_e_passed(0);
+
+  //  loop over tests
+  bool passed = true;
+
+  std::cout << "testing " << numTestLoops << " iterations" << std::endl;
+  for (uint test_ix = 0; test_ix < numTestLoops; test_ix++) {
+    std::cout << "test " << test_ix << std::endl;
+
+    // generate random inputs and the sums after each cycle
+    srand(test_ix); // set the random number generator to a known seed
+    uint64_t mask = (uint64_t(1) << N_BITS) - 1;
+    uint64_t k = rand() & mask;
+    std::vector<Inputs> inputs(N_CYCLES);
+    std::vector<Outputs> out_good(N_CYCLES);
+    uint64_t acc = 0;
+    uint64_t y = 0;
+    for (unsigned int cycle = 0; cycle < N_CYCLES; cycle++) {
+      if (cycle != HOLD_CYCLE) {
+        uint64_t x = rand() & mask;
+        inputs[cycle].push_back(to_bits(x, N_BITS));
+        inputs[cycle].push_back(to_bits(k, N_BITS));
+        y = x ^ k;
+      }
+      acc = (acc + y) & mask;
+      out_good[cycle].push_back(to_bits(acc, N_BITS));
+      std::cout << " cycle " << cycle << ": " << acc << std::endl;
+    }
+
+    //  execute program in circuit, then in the encrypted circuit
+    //  evaluator
+    for (unsigned int encrypted = 0; encrypted < 2; encrypted++) {
+      std::cout << "executing " << (encrypted ? "encrypted " : "")
+                << "circuit" << std::endl;
+      circ.Reset();
+      circ.setPlaintext(!encrypted);
+      circ.setEncrypted(encrypted);
+      circ.setVerify(encrypted);
+      bool match = true;
+      for (unsigned int cycle = 0; cycle < N_CYCLES; cycle++) {
+        if (cycle != HOLD_CYCLE) {
+          circ.SetInput(inputs[cycle]);
+        }
+        Outputs out = circ.Clock();
+        if (out != out_good[cycle]) {
+          std::cout << "cycle " << cycle << " output does not match"
+                    << std::endl;
+          match = false;
+        }
+      }
+      if (test_ix == 0) {
+        circ.dumpGateCount(); // of the last cycle
+      }
+      if (match) {
+        std::cout << "output match " << std::endl;
+        encrypted ? n_e_passed++ : n_p_passed++;
+      } else {
+        passed = false;
+      }
+    }
+  } // for test_ix
+  std::cout << "# tests total: " << numTestLoops << std::endl;
+  std::cout << "# passed plaintext: " << n_p_passed << std::endl;
+  std::cout << "# passed encrypted: " << n_e_passed << std::endl;
+
+  return passed;
+}
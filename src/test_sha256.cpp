@@ -86,8 +86,8 @@
 //
 
 bool test_sha256(std::string inFname, unsigned int numTestLoops,
-                 lbcrypto::BINFHE_PARAMSET set,
-                 lbcrypto::BINFHE_METHOD method) {
+                 std::shared_ptr<const CircuitClient> keys,
+                 ExecutorEnum executor, ScheduleEnum schedule) {
 
   std::cout << "test_sha256: Opening file " << inFname
             << " for test_sha256 parameters" << std::endl;
@@ -166,7 +166,9 @@ bool test_sha256(std::string inFname, unsigned int numTestLoops,
     exit(-1);
   }
 
-  Circuit circ(set, method);
+  Circuit circ(keys);
+  circ.setExecutor(executor);
+  circ.setSchedule(schedule);
   bool success = circ.ReadFile(inFname);
   if (!success) {
     std::cout << "error parsing file " << inFname << std::endl;
@@ -0,0 +1,175 @@
+// @file test_techmap.cpp -- runs the technology mapping passes
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other
+// contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+#include "./test_techmap.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "circuit.h"
+#include "techmap.h"
+
+/////
+
+//
+// test program for the technology mapping passes of techmap.h
+//
+// Description:
+// Loads a Bristol circuit, rewrites it with MapLuts(), FuseGates() and
+// MatchPatterns(), and runs every rewritten circuit on random inputs,
+// in plaintext and encrypted. The expected outputs are those of the
+// original circuit in plaintext, the other test programs check that
+// against the operation the circuit computes. Verify would repair every
+// gate that goes wrong, so the encrypted runs are made without it.
+//
+// Input
+//   inFname = input filename containing the bristol circuit
+//   new_flag = if true the file is in the new ("Bristol Fashion") format
+//   numTestLoops = number of times to test program
+// Output
+//   passed = if true then all tests passed
+//
+
+bool test_techmap(std::string inFname, bool new_flag,
+                  unsigned int numTestLoops,
+                  std::shared_ptr<const CircuitClient> keys,
+                  ExecutorEnum executor, ScheduleEnum schedule) {
+  std::cout << "test_techmap: Opening file " << inFname << std::endl;
+
+  Circuit circ(keys);
+  circ.setExecutor(executor);
+  circ.setSchedule(schedule);
+  bool success = circ.ReadBristolFile(inFname, new_flag);
+  if (!success) {
+    std::cerr << "error parsing file " << inFname << std::endl;
+    exit(-1);
+  }
+
+  // the same circuit rewritten by each pass. The gates a pass adds may
+  // need another encoding of the bits. Such a circuit can not run on
+  // keys, it gets a client of its own for that encoding, which also
+  // encrypts its inputs
+  auto xor_mode = keys->getXorMode();
+  auto ckt = circ.getCompiledCircuit();
+  std::vector<std::pair<std::string, std::shared_ptr<const CompiledCircuit>>>
+      passes = {{"LUT mapped", MapLuts(*ckt, xor_mode)},
+                {"fused", FuseGates(*ckt, xor_mode)},
+                {"pattern matched", MatchPatterns(*ckt, xor_mode)}};
+  std::vector<std::pair<std::string, std::unique_ptr<Circuit>>> rewritten;
+  for (auto &pass : passes) {
+    auto rw_keys = KeysForEncoding(keys, pass.second->RequiredEncoding());
+    std::unique_ptr<Circuit> rw_circ(new Circuit(rw_keys));
+    rw_circ->setExecutor(executor);
+    rw_circ->setSchedule(schedule);
+    rw_circ->setCompiledCircuit(pass.second);
+    rewritten.emplace_back(pass.first, std::move(rw_circ));
+  }
+
+  unsigned int n_p_passed(0);
+  unsigned int n_e_passed(0);
+
+  //  loop over tests
+  bool passed = true;
+
+  auto in_bits = circ.getInputBits();
+  std::cout << "testing " << numTestLoops << " iterations" << std::endl;
+  for (unsigned int test_ix = 0; test_ix < numTestLoops; test_ix++) {
+    std::cout << "test " << test_ix << std::endl;
+
+    // generate random inputs
+    srand(test_ix); // set the random number generator to a known seed
+    Inputs inputs;
+    for (auto n_bits : in_bits) {
+      std::vector<unsigned int> bus(n_bits);
+      for (auto &bit : bus) {
+        bit = rand() % 2;
+      }
+      inputs.push_back(bus);
+    }
+
+    //  the outputs of the original circuit
+
+    std::cout << "executing circuit" << std::endl;
+    circ.Reset();
+    circ.setPlaintext(true);
+    circ.SetInput(inputs);
+    Outputs out_good = circ.Clock();
+
+    //  execute the rewritten circuits
+
+    bool p_passed = true;
+    bool e_passed = true;
+    for (auto &rw : rewritten) {
+      std::cout << "executing " << rw.first << " circuit" << std::endl;
+      rw.second->Reset();
+      rw.second->setPlaintext(true);
+      rw.second->SetInput(inputs);
+      if (rw.second->Clock() == out_good) {
+        std::cout << "output match " << std::endl;
+      } else {
+        std::cout << rw.first << " output does not match" << std::endl;
+        p_passed = false;
+      }
+      rw.second->Reset();
+      rw.second->setEncrypted(true);
+      rw.second->SetInput(inputs);
+      if (rw.second->Clock() == out_good) {
+        std::cout << "encrypted output match " << std::endl;
+      } else {
+        std::cout << rw.first << " encrypted output does not match"
+                  << std::endl;
+        e_passed = false;
+      }
+      if (test_ix == 0) {
+        rw.second->dumpGateCount();
+      }
+    }
+    if (p_passed) {
+      n_p_passed++;
+    }
+    if (e_passed) {
+      n_e_passed++;
+    }
+    passed = passed && p_passed && e_passed;
+  } // for test_ix
+  std::cout << "# tests total: " << numTestLoops << std::endl;
+  std::cout << "# passed plaintext: " << n_p_passed << std::endl;
+  std::cout << "# passed encrypted: " << n_e_passed << std::endl;
+
+  return passed;
+}
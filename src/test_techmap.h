@@ -1,5 +1,4 @@
-// @file wire.cpp -- wire object for encrypted circuit evaluation object
-
+// @file test_techmap.h -- test code for the technology mapping passes
 //==================================================================================
 // BSD 2-Clause License
 //
@@ -33,33 +32,23 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 //==================================================================================
-#include "wire.h"
 
-#include <iostream>
+#ifndef SRC_TEST_TECHMAP_H_
+#define SRC_TEST_TECHMAP_H_
+
+#include <memory>
+#include <string>
+
+#include "binfhecontext.h"
 
-Wire::Wire(){};
-Wire::~Wire(){};
-void Wire::setName(std::string n) { this->name = n; }
-std::string Wire::getName(void) { return this->name; }
-void Wire::setValue(bool b) { this->value = b; }
-bool Wire::getValue(void) { return this->value; }
-void Wire::setCipherText(CipherText ct) { this->ct = ct; }
-CipherText Wire::getCipherText(void) { return this->ct; }
-void Wire::setFanoutGates(NameList f) { this->fanoutGates = f; }
-NameList Wire::getFanoutGates(void) { return this->fanoutGates; }
-unsigned int Wire::getNumberFanoutGates(void) {
-  return this->fanoutGates.size();
-}
+#include "client.h"
+#include "evaluation.h"
+#include "executor.h"
 
-void Wire::updateFanoutGates(std::string gateToRemove) {
-  auto w = std::find(this->fanoutGates.begin(), this->fanoutGates.end(),
-                     gateToRemove);
+// function declaration
+bool test_techmap(std::string inFname, bool new_flag,
+                  unsigned int num_test_loops,
+                  std::shared_ptr<const CircuitClient> keys,
+                  ExecutorEnum executor, ScheduleEnum schedule);
 
-  if (w != this->fanoutGates.end()) {
-    this->fanoutGates.erase(w);
-    // remove w
-  } else {
-    std::cout << "error, trying to remove node " << gateToRemove
-              << " from fanoutGates and it isn;t there" << std::endl;
-  }
-}
+#endif // SRC_TEST_TECHMAP_H_
@@ -42,6 +42,8 @@
 #include <sstream>
 #include <string>
 
+#include "client.h"
+
 bool contains(std::string s1, std::string s2) {
   return s1.find(s2) != std::string::npos;
 }
@@ -123,7 +125,11 @@ void parse_inputs(int argc, char **argv, bool *assemble_flag,
                   bool *gen_fan_flag, bool *analyze_flag, bool *verbose,
                   lbcrypto::BINFHE_PARAMSET *set,
                   lbcrypto::BINFHE_METHOD *method, unsigned int *n_cases,
-                  unsigned int *num_test_loops) {
+                  unsigned int *num_test_loops, bool *binary_flag,
+                  ExecutorEnum *executor, ScheduleEnum *schedule,
+                  std::string *key_store, XorEnum *xor_mode) {
+  // settings the test benches pass to their clients and circuits. The
+  // XOR mode is picked for the parameter set unless -x is given
   // manage the command line args
   int opt; // option from command line parsing
 
@@ -133,27 +139,41 @@ void parse_inputs(int argc, char **argv, bool *assemble_flag,
           " demo with settings (default value show in parenthesis):\n") +
       std::string("-a assemble flag (false) note, if true then analyze must be "
                   "true\n") +
+      std::string("-b write compiled circuit when assembling (false)\n") +
       std::string("-f fanout generation flag (false)\n") +
       std::string("-z analyze flag (false)\n") +
       std::string("-c # test cases (not used in all TB programs\n") +
       std::string("-n # test loops [10]\n") +
       std::string("-s parameter set (TOY|STD128_OPT) [STD128_OPT]\n") +
       std::string("-m method (AP|GINX) [GINX] \n") +
+      std::string("-e executor (OMP|POOL|SERIAL) [OMP]\n") +
+      std::string("-l schedule (DYNAMIC|LEVEL|ASYNC) [DYNAMIC]\n") +
+      std::string("-k key store directory, loads or saves the keys []\n") +
+      std::string("-x XOR mode (DECOMPOSED|NATIVE|FAST) "
+                  "[per parameter set]\n") +
       std::string("-v verbose flag (false)\n") +
       std::string("\nh prints this message\n");
 
   int num_test_loops_in;
   int n_cases_in;
+  bool xor_set = false;
 
-  while ((opt = getopt(argc, argv, "azfc:s:m:n:vh")) != -1) {
+  while ((opt = getopt(argc, argv, "azbfc:s:m:e:l:k:x:n:vh")) != -1) {
     std::string set_str;
     std::string method_str;
+    std::string executor_str;
+    std::string schedule_str;
+    std::string xor_str;
 
     switch (opt) {
     case 'a':
       *assemble_flag = true;
       std::cout << "assembling" << std::endl;
       break;
+    case 'b':
+      *binary_flag = true;
+      std::cout << "writing compiled circuit" << std::endl;
+      break;
     case 'f':
       *gen_fan_flag = true;
       std::cout << "fan_flag true" << std::endl;
@@ -188,6 +208,53 @@ void parse_inputs(int argc, char **argv, bool *assemble_flag,
         exit(-1);
       }
       break;
+    case 'e':
+      executor_str = optarg;
+      if (executor_str == "OMP") {
+        *executor = ExecutorEnum::OMP;
+      } else if (executor_str == "POOL") {
+        *executor = ExecutorEnum::POOL;
+      } else if (executor_str == "SERIAL") {
+        *executor = ExecutorEnum::SERIAL;
+      } else {
+        std::cerr << "Error Bad Executor chosen" << std::endl;
+        exit(-1);
+      }
+      std::cout << "using " << executor_str << " executor" << std::endl;
+      break;
+    case 'l':
+      schedule_str = optarg;
+      if (schedule_str == "DYNAMIC") {
+        *schedule = ScheduleEnum::DYNAMIC;
+      } else if (schedule_str == "LEVEL") {
+        *schedule = ScheduleEnum::LEVEL;
+      } else if (schedule_str == "ASYNC") {
+        *schedule = ScheduleEnum::ASYNC;
+      } else {
+        std::cerr << "Error Bad Schedule chosen" << std::endl;
+        exit(-1);
+      }
+      std::cout << "using " << schedule_str << " schedule" << std::endl;
+      break;
+    case 'k':
+      *key_store = optarg;
+      std::cout << "using key store " << optarg << std::endl;
+      break;
+    case 'x':
+      xor_str = optarg;
+      if (xor_str == "DECOMPOSED") {
+        *xor_mode = XorEnum::DECOMPOSED;
+      } else if (xor_str == "NATIVE") {
+        *xor_mode = XorEnum::NATIVE;
+      } else if (xor_str == "FAST") {
+        *xor_mode = XorEnum::FAST;
+      } else {
+        std::cerr << "Error Bad XOR mode chosen" << std::endl;
+        exit(-1);
+      }
+      xor_set = true;
+      std::cout << "using " << xor_str << " xor" << std::endl;
+      break;
     case 'c':
       n_cases_in = atoi(optarg);
       if (n_cases_in < 0) {
@@ -217,4 +284,7 @@ void parse_inputs(int argc, char **argv, bool *assemble_flag,
     }
   }
   *assemble_flag = true && *analyze_flag; // cant assemble without analysis
+  if (!xor_set) {
+    *xor_mode = DefaultXorMode(*set);
+  }
 }
@@ -42,6 +42,9 @@
 
 #include "binfhecontext.h"
 
+#include "evaluation.h"
+#include "executor.h"
+
 /**
  * Helper function to insure files exists
  *
@@ -77,6 +80,8 @@ void parse_inputs(int argc, char **argv, bool *assemble_flag,
                   bool *gen_fan_flag, bool *analyze_flag, bool *verbose,
                   lbcrypto::BINFHE_PARAMSET *set,
                   lbcrypto::BINFHE_METHOD *method, unsigned int *n_cases,
-                  unsigned int *num_test_loops);
+                  unsigned int *num_test_loops, bool *binary_flag,
+                  ExecutorEnum *executor, ScheduleEnum *schedule,
+                  std::string *key_store, XorEnum *xor_mode);
 
 #endif // SRC_UTILS_H_
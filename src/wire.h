@@ -1,4 +1,4 @@
-// @file wire.h -- wire object for encrypted circuit evaluation object
+// @file wire.h -- wire types for encrypted circuit evaluation
 //==================================================================================
 // BSD 2-Clause License
 //
@@ -37,39 +37,13 @@
 #define WIRE_H
 
 #include "binfhecontext.h"
-#include <algorithm>
 #include <deque>
 #include <string>
 #include <vector>
 
 using NameList = std::vector<std::string>;
+using WireIdList = std::vector<unsigned int>;
 using CipherText = lbcrypto::LWECiphertext;
-
-class Wire {
-public:
-  Wire();
-  ~Wire();
-  void setName(std::string n);
-  std::string getName(void);
-  void setValue(bool b);
-  bool getValue(void);
-  void setFanoutGates(NameList f);
-  NameList getFanoutGates(void);
-  unsigned int getNumberFanoutGates(void);
-  void setCipherText(CipherText ct);
-  CipherText getCipherText(void);
-
-  void updateFanoutGates(std::string gateToRemove);
-
-private:
-  std::string name;     // note can be an integer
-  NameList fanoutGates; // list of gates this wire fans out to
-  bool value;
-  CipherText ct; // used for encrypted value
-};
-
-using WireList = std::vector<Wire>;
-using WireNameList = std::vector<std::string>;
-using WireQueue = std::deque<Wire>;
+using WireIdQueue = std::deque<unsigned int>;
 
 #endif